@@ -0,0 +1,259 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ *
+ * Measure parser, buffer and dispatch costs on the board. Results are
+ * printed as ns/op and bytes/sec, so compare runs of the same board after
+ * a change. The micros() resolution is 4us on AVR, so each test loops
+ * BENCH_LOOPS times. On a host, build it with test/CMakeLists.txt.
+ */
+
+#include <CmdBuffer.h>
+#include <CmdCallback.h>
+#include <CmdParser.h>
+
+#ifndef BENCH_LOOPS
+#define BENCH_LOOPS 1000
+#endif
+
+/**
+ * Stream with data from memory, replays the data in a endless loop.
+ */
+class MemStream : public Stream
+{
+  public:
+    MemStream(const char *data) : m_data(data), m_pos(0) {}
+
+    virtual int available() { return 1; }
+    virtual int peek() { return static_cast<uint8_t>(m_data[m_pos]); }
+    virtual int read()
+    {
+        int c = static_cast<uint8_t>(m_data[m_pos++]);
+
+        if (m_data[m_pos] == 0x00) {
+            m_pos = 0;
+        }
+        return c;
+    }
+    virtual size_t write(uint8_t) { return 1; }
+    virtual void   flush() {}
+
+  private:
+    const char *m_data;
+    size_t      m_pos;
+};
+
+CmdParser cmdParser;
+char      line[160];
+char      cmdNames[32][4];
+
+void benchNop(CmdParser *) {}
+
+void report(const char *name, uint16_t arg, unsigned long ops,
+            unsigned long bytes, unsigned long us)
+{
+    Serial.print(name);
+    Serial.print(F(" "));
+    Serial.print(arg);
+    Serial.print(F(": "));
+    Serial.print(1000.0 * us / ops);
+    Serial.print(F(" ns/op"));
+    if (bytes > 0 && us > 0) {
+        Serial.print(F(", "));
+        Serial.print(1000000.0 * bytes / us);
+        Serial.print(F(" bytes/sec"));
+    }
+    Serial.println();
+}
+
+// parseCmd with a copy of the line for each loop
+void benchParse(const char *cmd)
+{
+    size_t        size = strlen(cmd);
+    unsigned long start;
+
+    start = micros();
+    for (uint16_t i = 0; i < BENCH_LOOPS; i++) {
+        memcpy(line, cmd, size + 1);
+        cmdParser.parseCmd(reinterpret_cast<uint8_t *>(line), size);
+    }
+    report("parseCmd words", cmdParser.getParamCount() + 1, BENCH_LOOPS,
+           static_cast<unsigned long>(size) * BENCH_LOOPS, micros() - start);
+}
+
+// getCmdParam inside and behind the token index
+void benchParam(uint16_t idx)
+{
+    unsigned long start;
+    uint16_t      found = 0;
+
+    start = micros();
+    for (uint16_t i = 0; i < BENCH_LOOPS; i++) {
+        if (cmdParser.getCmdParam(idx) != NULL) {
+            found++;
+        }
+    }
+    report("getCmdParam idx", idx, BENCH_LOOPS, 0, micros() - start);
+    if (found != BENCH_LOOPS) {
+        Serial.println(F("  param not found"));
+    }
+}
+
+// getValueFromKey of the last key pair
+void benchKey(uint16_t pairs)
+{
+    unsigned long start;
+    size_t        size = 0;
+    char          key[4];
+
+    // i.e. "set K0=1 K1=1 ..."
+    line[size++] = 's';
+    for (uint16_t i = 0; i < pairs; i++) {
+        line[size++] = ' ';
+        line[size++] = 'K';
+        line[size++] = '0' + i / 10;
+        line[size++] = '0' + i % 10;
+        line[size++] = '=';
+        line[size++] = '1';
+    }
+    line[size] = 0x00;
+
+    key[0] = 'K';
+    key[1] = '0' + (pairs - 1) / 10;
+    key[2] = '0' + (pairs - 1) % 10;
+    key[3] = 0x00;
+
+    cmdParser.setOptKeyValue(true);
+    cmdParser.parseCmd(line);
+
+    start = micros();
+    for (uint16_t i = 0; i < BENCH_LOOPS; i++) {
+        cmdParser.getValueFromKey(key);
+    }
+    report("getValueFromKey pairs", pairs, BENCH_LOOPS, 0, micros() - start);
+    cmdParser.setOptKeyValue(false);
+}
+
+// readSerialChar from memory, a line is ready at each end char
+void benchRead()
+{
+    MemStream     stream("led set 12 on\n");
+    CmdBuffer<32> cmdBuffer;
+    unsigned long start;
+    unsigned long bytes = 14UL * BENCH_LOOPS;
+
+    start = micros();
+    for (unsigned long i = 0; i < bytes; i++) {
+        if (cmdBuffer.readSerialChar(&stream)) {
+            cmdBuffer.clear();
+        }
+    }
+    report("readSerialChar line", 14, bytes, bytes, micros() - start);
+}
+
+// clear of COUNT buffers with a line of SIZE chars, the lines are read
+// before the time is taken. With FULL the whole buffer is cleared, as clear
+// did before only the used part was cleared.
+template <size_t BUFFERSIZE, uint8_t COUNT>
+void benchClear(size_t size, bool full)
+{
+    CmdBuffer<BUFFERSIZE> cmdBuffer[COUNT];
+    unsigned long         start;
+    unsigned long         total = 0;
+
+    memset(line, 'x', size);
+    line[size] = '\n';
+
+    for (uint16_t i = 0; i < BENCH_LOOPS / COUNT; i++) {
+        for (uint8_t j = 0; j < COUNT; j++) {
+            cmdBuffer[j].readChars(reinterpret_cast<uint8_t *>(line),
+                                   size + 1);
+        }
+
+        start = micros();
+        for (uint8_t j = 0; j < COUNT; j++) {
+            if (full) {
+                memset(cmdBuffer[j].getBuffer(), 0x00, BUFFERSIZE + 1);
+            } else {
+                cmdBuffer[j].clear();
+            }
+        }
+        total += micros() - start;
+    }
+    report(full ? "clear full, buffer" : "clear line, buffer", BUFFERSIZE,
+           BENCH_LOOPS / COUNT * COUNT, 0, total);
+}
+
+// processCmd of the last command in the store
+template <class STORE>
+void benchDispatch(const char *name, STORE *store, uint16_t size)
+{
+    unsigned long start;
+
+    for (uint16_t i = 0; i < size; i++) {
+        store->addCmd(cmdNames[i], benchNop);
+    }
+
+    strcpy(line, cmdNames[size - 1]);
+    cmdParser.parseCmd(line);
+
+    start = micros();
+    for (uint16_t i = 0; i < BENCH_LOOPS; i++) {
+        store->processCmd(&cmdParser);
+    }
+    report(name, size, BENCH_LOOPS, 0, micros() - start);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    for (uint16_t i = 0; i < 32; i++) {
+        cmdNames[i][0] = 'c';
+        cmdNames[i][1] = '0' + i / 10;
+        cmdNames[i][2] = '0' + i % 10;
+        cmdNames[i][3] = 0x00;
+    }
+
+    benchParse("led on");
+    benchParse("set motor speed=120 dir=left \"ramp 20\" 0x1F 3.25");
+    benchParse("a b c d e f g h i j k l m n o p q r s t u v w x y z "
+               "0 1 2 3 4 5 6 7 8 9");
+
+    // line is still parsed with 36 words
+    benchParam(1);
+    benchParam(CMDPARSER_MAX_TOKENS - 1);
+    benchParam(35);
+
+    benchKey(1);
+    benchKey(4);
+    benchKey(16);
+
+    benchRead();
+
+    // line of 8 chars
+    benchClear<64, 8>(8, false);
+    benchClear<64, 8>(8, true);
+    benchClear<256, 2>(8, false);
+    benchClear<256, 2>(8, true);
+
+    {
+        CmdCallback<4>  store4;
+        CmdCallback<16> store16;
+        CmdCallback<32> store32;
+
+        benchDispatch("processCmd linear", &store4, 4);
+        benchDispatch("processCmd linear", &store16, 16);
+        benchDispatch("processCmd linear", &store32, 32);
+    }
+    {
+        CmdCallbackHash<16> hash16;
+        CmdCallbackHash<32> hash32;
+
+        benchDispatch("processCmd hash", &hash16, 16);
+        benchDispatch("processCmd hash", &hash32, 32);
+    }
+}
+
+void loop() {}
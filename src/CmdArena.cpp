@@ -0,0 +1,151 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include "CmdArena.h"
+
+CmdArenaObject::CmdArenaObject(uint8_t *data, uint8_t *map, size_t blockSize,
+                               size_t blockCount)
+    : m_data(data),
+      m_map(map),
+      m_blockSize(blockSize),
+      m_blockCount(blockCount),
+      m_usedCount(0),
+      m_maxLine(blockSize * blockCount - 1)
+{
+    memset(m_map, 0x00, (blockCount + 7) / 8);
+}
+
+uint8_t *CmdArenaObject::alloc(size_t size)
+{
+    size_t count = this->blocks(size);
+    size_t block;
+
+    if (count == 0 || count > m_blockCount - m_usedCount) {
+        return NULL;
+    }
+
+    // first run of free blocks
+    for (block = 0; block + count <= m_blockCount; block++) {
+        if (this->isFree(block, count)) {
+            this->markBlocks(block, count, true);
+            return &m_data[block * m_blockSize];
+        }
+    }
+
+    return NULL;
+}
+
+uint8_t *CmdArenaObject::grow(uint8_t *data, size_t size, size_t newSize)
+{
+    size_t   count    = this->blocks(size);
+    size_t   newCount = this->blocks(newSize);
+    size_t   block;
+    uint8_t *newData;
+
+    if (data == NULL) {
+        return this->alloc(newSize);
+    }
+
+    block = (data - m_data) / m_blockSize;
+    if (newCount <= count) {
+        return data;
+    }
+
+    // grow in place
+    if (block + newCount <= m_blockCount &&
+        this->isFree(block + count, newCount - count)) {
+        this->markBlocks(block + count, newCount - count, true);
+        return data;
+    }
+
+    // move to a new run, it can overlap the old one
+    this->markBlocks(block, count, false);
+    newData = this->alloc(newSize);
+    if (newData == NULL) {
+        this->markBlocks(block, count, true);
+        return NULL;
+    }
+
+    memmove(newData, data, size);
+    return newData;
+}
+
+void CmdArenaObject::release(uint8_t *data, size_t size)
+{
+    if (data == NULL) {
+        return;
+    }
+
+    this->markBlocks((data - m_data) / m_blockSize, this->blocks(size), false);
+}
+
+void CmdArenaObject::markBlocks(size_t block, size_t count, bool used)
+{
+    for (size_t i = block; i < block + count; i++) {
+        if (used) {
+            m_map[i / 8] |= 1 << (i % 8);
+        } else {
+            m_map[i / 8] &= ~(1 << (i % 8));
+        }
+    }
+
+    if (used) {
+        m_usedCount += count;
+    } else {
+        m_usedCount -= count;
+    }
+}
+
+bool CmdArenaObject::isFree(size_t block, size_t count)
+{
+    for (size_t i = block; i < block + count; i++) {
+        if (m_map[i / 8] & (1 << (i % 8))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CmdArenaBuffer::clear()
+{
+    size_t size;
+
+    this->clearLine();
+    this->getLine(&size);
+
+    // next line is in receiving
+    if (size > 0) {
+        return;
+    }
+
+    m_arena->release(m_line, m_lineSize);
+    m_line     = NULL;
+    m_lineSize = 0;
+}
+
+bool CmdArenaBuffer::lineFull(size_t /* size */)
+{
+    size_t   newSize = m_lineSize + m_arena->getBlockSize();
+    uint8_t *line;
+
+    // line and '\0' up to maximum
+    if (newSize > m_arena->getMaxLine() + 1) {
+        newSize = m_arena->getMaxLine() + 1;
+    }
+    if (newSize <= m_lineSize) {
+        return false;
+    }
+
+    line = m_arena->grow(m_line, m_lineSize, newSize);
+    if (line == NULL) {
+        return false;
+    }
+
+    m_line     = line;
+    m_lineSize = newSize;
+    return true;
+}
@@ -0,0 +1,234 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#ifndef _CMDARENA_H_
+#define _CMDARENA_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#include "CmdBuffer.h"
+
+/**
+ * Pool of fixed size blocks for lines of many buffers @see CmdArenaBuffer.
+ * A line use a run of blocks in a row, so the parser can work on it. The
+ * run grows in place if the next blocks are free, otherwise it is moved.
+ */
+class CmdArenaObject
+{
+  public:
+    /**
+     * Set storage of arena.
+     *
+     * @param data          Storage for blocks
+     * @param map           Storage for a bit of each block
+     * @param blockSize     Size of a block
+     * @param blockCount    Number of blocks
+     */
+    CmdArenaObject(uint8_t *data, uint8_t *map, size_t blockSize,
+                   size_t blockCount);
+
+    /**
+     * Get a run of blocks.
+     *
+     * @param size          Number of bytes
+     * @return              Start of run or NULL if no room
+     */
+    uint8_t *alloc(size_t size);
+
+    /**
+     * Grow a run of blocks, the data is moved if the next blocks are used.
+     *
+     * @param data          Start of run
+     * @param size          Number of bytes of run
+     * @param newSize       Number of bytes after grow
+     * @return              Start of run or NULL if no room, the old run
+     *                      is still valid
+     */
+    uint8_t *grow(uint8_t *data, size_t size, size_t newSize);
+
+    /**
+     * Give a run of blocks back to arena.
+     *
+     * @param data          Start of run or NULL
+     * @param size          Number of bytes of run
+     */
+    void release(uint8_t *data, size_t size);
+
+    /**
+     * Set the maximum size of a line in all buffers of arena.
+     * Default is the whole arena
+     *
+     * @param size          Size of line without '\0'
+     */
+    void setMaxLine(size_t size) { m_maxLine = size; }
+
+    /**
+     * Get the maximum size of a line @see setMaxLine.
+     *
+     * @return              Size of line without '\0'
+     */
+    size_t getMaxLine() { return m_maxLine; }
+
+    /**
+     * Get size of a block.
+     *
+     * @return              Number of bytes
+     */
+    size_t getBlockSize() { return m_blockSize; }
+
+    /**
+     * Get number of unused blocks.
+     *
+     * @return              Number of blocks
+     */
+    size_t getFreeBlocks() { return m_blockCount - m_usedCount; }
+
+  private:
+    /**
+     * Mark blocks as used or free.
+     *
+     * @param block         First block
+     * @param count         Number of blocks
+     * @param used          TRUE for used
+     */
+    void markBlocks(size_t block, size_t count, bool used);
+
+    /**
+     * Check if blocks are free.
+     *
+     * @param block         First block
+     * @param count         Number of blocks
+     * @return              TRUE if all blocks are free
+     */
+    bool isFree(size_t block, size_t count);
+
+    /**
+     * Calc number of blocks for a size.
+     */
+    size_t blocks(size_t size)
+    {
+        return (size + m_blockSize - 1) / m_blockSize;
+    }
+
+    /** Storage of blocks */
+    uint8_t *m_data;
+
+    /** Bit of each block, set if used */
+    uint8_t *m_map;
+
+    /** Size and number of blocks */
+    size_t m_blockSize;
+    size_t m_blockCount;
+    size_t m_usedCount;
+
+    /** Maximum size of a line @see setMaxLine */
+    size_t m_maxLine;
+};
+
+/**
+ *
+ *
+ */
+template <size_t BLOCKSIZE, size_t BLOCKCOUNT>
+class CmdArena : public CmdArenaObject
+{
+    static_assert(BLOCKSIZE > 0 && BLOCKCOUNT > 0,
+                  "CmdArena needs blocks");
+
+  public:
+    /**
+     * Set storage of arena
+     */
+    CmdArena()
+        : CmdArenaObject(m_arena, m_arenaMap, BLOCKSIZE, BLOCKCOUNT)
+    {
+    }
+
+  private:
+    /** Storage of blocks */
+    uint8_t m_arena[BLOCKSIZE * BLOCKCOUNT];
+
+    /** Bit of each block */
+    uint8_t m_arenaMap[(BLOCKCOUNT + 7) / 8];
+};
+
+/**
+ * Buffer with a line from a arena, shared with other buffers. The line
+ * grows with a block if it is full, up to CmdArenaObject::getMaxLine.
+ * Blocks are given back with clear, so a buffer only use memory while it
+ * receive a line or the line wait for parsing.
+ */
+class CmdArenaBuffer : public CmdBufferObject
+{
+  public:
+    /**
+     * Set arena of the lines.
+     *
+     * @param arena         Arena for all lines of buffer
+     */
+    CmdArenaBuffer(CmdArenaObject *arena)
+        : m_arena(arena), m_line(NULL), m_lineSize(0), m_empty(0x00)
+    {
+    }
+
+    /**
+     * Give the line back to arena
+     */
+    ~CmdArenaBuffer() { m_arena->release(m_line, m_lineSize); }
+
+    /**
+     * A copy would give the same blocks back twice
+     */
+    CmdArenaBuffer(const CmdArenaBuffer &) = delete;
+    CmdArenaBuffer &operator=(const CmdArenaBuffer &) = delete;
+
+    /**
+     * Give the line back to arena, if no new line is in receiving.
+     * @interface CmdBufferObject
+     */
+    virtual void clear();
+
+    /**
+     * Return the line or a empty string.
+     * @interface CmdBufferObject
+     */
+    virtual uint8_t *getBuffer()
+    {
+        return m_line != NULL ? m_line : &m_empty;
+    }
+
+    /**
+     * Return size of line without '\0', it grows while receiving.
+     * @interface CmdBufferObject
+     */
+    virtual size_t getBufferSize()
+    {
+        return m_lineSize > 0 ? m_lineSize - 1 : 0;
+    }
+
+  protected:
+    /**
+     * Grow the line with a block from arena.
+     * @interface CmdBufferObject
+     */
+    virtual bool lineFull(size_t size);
+
+  private:
+    /** Arena of lines */
+    CmdArenaObject *m_arena;
+
+    /** Line with '\0' and number of bytes */
+    uint8_t *m_line;
+    size_t   m_lineSize;
+
+    /** Empty string without a line */
+    uint8_t m_empty;
+};
+
+#endif
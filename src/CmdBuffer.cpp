@@ -5,6 +5,8 @@
  */
 
 #include "CmdBuffer.h"
+#include "CmdParser.h"
+#include "CmdQueue.h"
 
 /**
  * Clear buffer and set defaults.
@@ -17,35 +19,41 @@ CmdBufferObject::CmdBufferObject()
         m_ID(CMDBUFFER_NO_ID),
         m_foundStartChar(0),
         m_dataOffset(0),
-        m_echo(false)
+        m_usedSize(0),
+        m_dataSize(0),
+        m_echo(false),
+        m_binary(false),
+        m_frameEscape(false),
+        m_frameDrop(false),
+        m_frameCrc(CMDBUFFER_CRC_INIT),
+        m_checkMode(CMDBUFFER_CHECK_NONE),
+        m_checkTrailer(false),
+        m_checkDigits(0),
+        m_checkSum(0),
+        m_checkValue(0),
+        m_rewindSize(0),
+        m_rewindSum(0),
+        m_stream(),
+        m_parser(NULL),
+        m_idleFunct(NULL)
 {
+#if defined(CMDBUFFER_STATS)
+    this->clearStats();
+#endif
 }
 
 
 bool CmdBufferObject::readFromSerial(Stream *serial, uint32_t timeOut)
 {
-    uint32_t isTimeOut;
     uint32_t startTime;
-    bool     over = false;
+    uint32_t waitTime;
 
     // UART initialize?
     if (serial == NULL) {
         return false;
     }
 
-    ////
-    // Calc Timeout
-    if (timeOut != 0) {
-        startTime = millis();
-        isTimeOut = startTime + timeOut;
-
-        // overloaded
-        if (isTimeOut < startTime) {
-            over = true;
-        } else {
-            over = false;
-        }
-    }
+    startTime = millis();
 
     ////
     // process serial reading
@@ -54,24 +62,28 @@ bool CmdBufferObject::readFromSerial(Stream *serial, uint32_t timeOut)
         // if data in serial input buffer
         while (serial->available()) {
 
-            if (this->readSerialChar(serial)) {
+            if (this->readSerialBlock(serial)) {
                 return true;
             }
         }
 
-        // Timeout is active?
+        // Timeout is active? unsigned difference is save on millis overflow
+        waitTime = 0;
         if (timeOut != 0) {
-            // calc diff timeout
-            if (over) {
-                if (startTime > millis()) {
-                    over = false;
-                }
-            }
+            waitTime = millis() - startTime;
 
             // timeout is receive
-            if (isTimeOut <= millis() && !over) {
+            if (waitTime >= timeOut) {
                 return false;
             }
+            waitTime = timeOut - waitTime;
+        }
+
+        // wait for data
+        if (m_idleFunct != NULL) {
+            m_idleFunct(serial, waitTime);
+        } else {
+            yield();
         }
 
     } while (true); // timeout
@@ -80,87 +92,504 @@ bool CmdBufferObject::readFromSerial(Stream *serial, uint32_t timeOut)
 }
 
 
-// Checks for start and end characters
-// Saves printable characters in buffer
+// Read one char from serial
 // @return  true if line terminator found
 bool CmdBufferObject::readSerialChar(Stream *serial)
 {
-    uint8_t  readChar;
-    uint8_t *buffer = this->getBuffer();
-
     // UART initialize?
     if (serial == NULL) {
         return false;
     }
 
     if (serial->available()) {
-        // is buffer full?
-        if (m_dataOffset >= this->getBufferSize()) {
+        return this->storeChar(serial->read(), serial);
+    }
+    return false;
+}
+
+
+// Read all available chars from serial as one block
+// @return  true if line terminator found
+bool CmdBufferObject::readSerialBlock(Stream *serial)
+{
+    uint8_t *buffer = this->getLineBuffer();
+    size_t   size;
+    size_t   count;
+    size_t   start;
+
+    // UART initialize?
+    if (serial == NULL) {
+        return false;
+    }
+
+    size = serial->available();
+    if (size == 0) {
+        return false;
+    }
+
+    // is buffer full? byte path will handle it
+    // binary frames too, readBytesUntil can't stop at CMDBUFFER_SLIP_END
+    // if char is signed
+    if (m_dataOffset >= this->getLineSize() || m_binary) {
+        return this->readSerialChar(serial);
+    }
+
+    // read raw data behind data offset, the end character is removed
+    // from stream but not stored
+    if (size > this->getLineSize() - m_dataOffset) {
+        size = this->getLineSize() - m_dataOffset;
+    }
+    count = serial->readBytesUntil(
+        static_cast<char>(m_endChar),
+        reinterpret_cast<char *>(buffer + m_dataOffset), size);
+
+    // process raw data in place, data offset never pass the read position
+    start = m_dataOffset;
+    if (start + count > m_usedSize) {
+        m_usedSize = start + count;
+    }
+    for (size_t i = 0; i < count; i++) {
+        this->storeChar(buffer[start + i], serial);
+    }
+
+    // less data as available, so end character was read
+    if (count < size) {
+        return this->storeChar(m_endChar, serial);
+    }
+    return false;
+}
+
+
+// Read chars from memory
+// @return  true if line terminator found
+bool CmdBufferObject::readChars(const uint8_t *data, size_t size, size_t *count)
+{
+    size_t i;
+    bool   found = false;
+
+    for (i = 0; i < size && !found; i++) {
+        found = this->storeChar(data[i], NULL);
+    }
+
+    if (count != NULL) {
+        *count = i;
+    }
+    return found;
+}
+
+
+// Read chars from queue
+// @return  true if line terminator found
+bool CmdBufferObject::readFromQueue(CmdQueueObject *queue)
+{
+    int readChar;
+
+    if (queue == NULL) {
+        return false;
+    }
+
+    while ((readChar = queue->read()) >= 0) {
+        if (this->storeChar(readChar, NULL)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Checks for start and end characters
+// Saves printable characters in buffer
+// @return  true if line terminator found
+bool CmdBufferObject::storeChar(uint8_t readChar, Stream *serial)
+{
+    uint8_t *buffer;
+
+    if (m_binary) {
+        return this->storeFrame(readChar);
+    }
+
+    // is buffer full?
+    if (m_dataOffset >= this->getLineSize()) {
+        if (this->lineFull(m_dataOffset)) {
+            // line is moved
+            this->parseLine();
+        }
+        else {
+#if defined(CMDBUFFER_STATS)
+            if (m_dataOffset > 0) {
+                m_stats.overflows++;
+                m_stats.drops += m_dataOffset;
+            }
+#endif
             m_dataOffset = 0;
             m_foundStartChar = 0;
+            this->resetCheck();
+
+            // no room for a new line
+            if (this->getLineSize() == 0) {
+#if defined(CMDBUFFER_STATS)
+                m_stats.drops++;
+#endif
+                return false;
+            }
+        }
+    }
+    buffer = this->getLineBuffer();
+
+    if (m_echo && serial != NULL) {
+        serial->write(readChar);
+    }
+
+    // is that the start character?
+    if ( (m_strtChar != 0) && (m_foundStartChar < m_numStrtChars) ) {
+        if (readChar == m_strtChar ) {
+            // multiple start characters can be configured. This counts
+            // how many we have so far
+            m_foundStartChar++;       // if found, increment count
+                                      // but dont save anything in the buffer
+        }
+        else {
+#if defined(CMDBUFFER_STATS)
+            if (m_foundStartChar > 0) {
+                m_stats.resets++;
+            }
+#endif
+            m_foundStartChar = 0;     // start charactes must be  consecutive
+        }
+        return false;    // if not, try again next time
+    }
+    // if we get here, then the start character(s) were found
+
+    // is that the device ID?
+    if ( (m_ID != CMDBUFFER_NO_ID) && (m_foundStartChar == m_numStrtChars) ) {
+        if (readChar == m_ID ) {
+            m_foundStartChar++;        // if found, increment count
+                                       // but dont save anything in the buffer
+        }
+        else {
+#if defined(CMDBUFFER_STATS)
+            m_stats.resets++;
+#endif
+            m_foundStartChar = 0;       // ID MUST immediatly follow the start
+                                        // character, otherwise the message is not
+                                        // for us. Clear the flag and start over.
+        }
+        return false;    // if not, try again next time
+    }
+    // if we get this far, we have a valid ID
+
+    // is that the end of command?
+    if (readChar == m_endChar) {
+
+        // drop line with wrong checksum
+        if (m_checkMode != CMDBUFFER_CHECK_NONE &&
+            (!m_checkTrailer ||
+             m_checkDigits != (m_checkMode == CMDBUFFER_CHECK_NMEA ? 2 : 4) ||
+             m_checkValue != m_checkSum)) {
+#if defined(CMDBUFFER_STATS)
+            m_stats.crcErrors++;
+#endif
+            m_dataOffset     = 0;
+            m_foundStartChar = 0;
+            this->resetCheck();
             return false;
         }
+        this->resetCheck();
 
-        // read into buffer
-        readChar = serial->read();
+        if (m_parser != NULL) {
+            m_parser->endIncremental(m_dataOffset);
+        }
 
-        if (m_echo) {
-            serial->write(readChar);
+        buffer[m_dataOffset] = '\0';
+        m_dataSize           = m_dataOffset;
+        this->lineEnd(m_dataOffset);
+        m_dataOffset         = 0;
+        m_foundStartChar     = 0;
+#if defined(CMDBUFFER_STATS)
+        m_stats.lines++;
+#endif
+        return true;
+    }
+
+    // checksum trailer is not stored
+    if (m_checkMode != CMDBUFFER_CHECK_NONE && this->storeCheck(readChar)) {
+        return false;
+    }
+
+    // is that a backspace char?
+    if ((readChar == m_bsChar) && (m_dataOffset > 0)) {
+        // data kept by rewindLine is already handled
+        if (m_dataOffset <= m_rewindSize) {
+            return false;
         }
 
-        // is that the start character?
-        if ( (m_strtChar != 0) && (m_foundStartChar < m_numStrtChars) ) {
-            if (readChar == m_strtChar ) {
-                // multiple start characters can be configured. This counts
-                // how many we have so far
-                m_foundStartChar++;       // if found, increment count
-                                          // but dont save anything in the buffer
-            }
-            else {
-                m_foundStartChar = 0;     // start charactes must be  consecutive
+        // buffer[--m_dataOffset] = 0;
+        --m_dataOffset;
+
+        // parser can't undo a character
+        this->parseLine();
+
+        // XOR can be undone, CRC is calculated again from rewind
+        if (m_checkMode == CMDBUFFER_CHECK_NMEA) {
+            m_checkSum ^= buffer[m_dataOffset];
+        } else if (m_checkMode == CMDBUFFER_CHECK_CRC16) {
+            m_checkSum = m_rewindSum;
+            for (size_t i = m_rewindSize; i < m_dataOffset; i++) {
+                m_checkSum = CmdBufferObject::crc16(m_checkSum, buffer[i]);
             }
-            return false;    // if not, try again next time
         }
-        // if we get here, then the start character(s) were found
+#if defined(CMDBUFFER_STATS)
+        m_stats.backspaces++;
+#endif
+        if (m_echo && serial != NULL) {
+            serial->write(' ');
+            serial->write(readChar);
+        }
+        return false;
+    }
 
-        // is that the device ID?
-        if ( (m_ID != CMDBUFFER_NO_ID) && (m_foundStartChar == m_numStrtChars) ) {
-            if (readChar == m_ID ) {
-                m_foundStartChar++;        // if found, increment count
-                                           // but dont save anything in the buffer
-            }
-            else {
-                m_foundStartChar = 0;       // ID MUST immediatly follow the start
-                                            // character, otherwise the message is not
-                                            // for us. Clear the flag and start over.
+    // if is a printable character, finally save it in the buffer
+    if (readChar > CMDBUFFER_CHAR_PRINTABLE) {
+        if (m_checkMode == CMDBUFFER_CHECK_NMEA) {
+            m_checkSum ^= readChar;
+        } else if (m_checkMode == CMDBUFFER_CHECK_CRC16) {
+            m_checkSum = CmdBufferObject::crc16(m_checkSum, readChar);
+        }
+        buffer[m_dataOffset] = readChar;
+        if (m_parser != NULL) {
+            if (m_dataOffset == 0) {
+                m_parser->beginIncremental(buffer);
             }
-            return false;    // if not, try again next time
+            m_parser->parseIncremental(m_dataOffset);
+        }
+        m_dataOffset++;
+        if (m_dataOffset > m_usedSize) {
+            m_usedSize = m_dataOffset;
         }
-        // if we get this far, we have a valid ID
+    }
+    return false;
+}
 
-        // is that the end of command?
-        if (readChar == m_endChar) {
-            buffer[m_dataOffset] = '\0';
-            m_dataOffset         = 0;
-            m_foundStartChar     = 0;
-            return true;
+// Decode SLIP and check CRC of a binary frame
+// @return  true if a valid frame ends
+bool CmdBufferObject::storeFrame(uint8_t readChar)
+{
+    uint8_t *buffer;
+    size_t   size;
+
+    // end of frame, empty and counted broken frames are ignored
+    if (readChar == CMDBUFFER_SLIP_END) {
+        if (m_dataOffset == 0 || m_frameDrop) {
+            this->resetFrame();
+            return false;
         }
 
-        // is that a backspace char?
-        if ((readChar == m_bsChar) && (m_dataOffset > 0)) {
-            // buffer[--m_dataOffset] = 0;
-            --m_dataOffset;
-            if (m_echo) {
-                serial->write(' ');
-                serial->write(readChar);
-            }
+        // CRC over payload and CRC is 0
+        if (m_frameEscape || m_dataOffset <= 2 || m_frameCrc != 0) {
+#if defined(CMDBUFFER_STATS)
+            m_stats.crcErrors++;
+#endif
+            this->resetFrame();
             return false;
         }
 
-        // if is a printable character, finally save it in the buffer
-        if (readChar > CMDBUFFER_CHAR_PRINTABLE) {
-            buffer[m_dataOffset++] = readChar;
+        size         = m_dataOffset - 2;
+        buffer       = this->getLineBuffer();
+        buffer[size] = '\0';
+        m_dataSize   = size;
+        this->lineEnd(size);
+        this->resetFrame();
+#if defined(CMDBUFFER_STATS)
+        m_stats.lines++;
+#endif
+        return true;
+    }
+
+    // rest of a broken frame
+    if (m_frameDrop) {
+        return false;
+    }
+
+    // decode escaped byte
+    if (m_frameEscape) {
+        m_frameEscape = false;
+        if (readChar == CMDBUFFER_SLIP_ESC_END) {
+            readChar = CMDBUFFER_SLIP_END;
+        } else if (readChar == CMDBUFFER_SLIP_ESC_ESC) {
+            readChar = CMDBUFFER_SLIP_ESC;
+        } else {
+#if defined(CMDBUFFER_STATS)
+            m_stats.crcErrors++;
+#endif
+            m_frameDrop = true;
+            return false;
         }
+    } else if (readChar == CMDBUFFER_SLIP_ESC) {
+        m_frameEscape = true;
+        return false;
+    }
+
+    // is buffer full? the frame can't be resynchronized, drop it
+    if (m_dataOffset >= this->getLineSize() && !this->lineFull(m_dataOffset)) {
+#if defined(CMDBUFFER_STATS)
+        m_stats.overflows++;
+        m_stats.drops += m_dataOffset;
+#endif
+        m_dataOffset = 0;
+        m_frameDrop  = true;
+        return false;
+    }
+
+    buffer                 = this->getLineBuffer();
+    buffer[m_dataOffset++] = readChar;
+    m_frameCrc             = CmdBufferObject::crc16(m_frameCrc, readChar);
+    if (m_dataOffset > m_usedSize) {
+        m_usedSize = m_dataOffset;
     }
     return false;
 }
+
+
+// Read '*' and hex digits of a checksum trailer
+// @return  true if char is part of the trailer
+bool CmdBufferObject::storeCheck(uint8_t readChar)
+{
+    uint8_t digit;
+
+    if (!m_checkTrailer) {
+        if (readChar != CMDBUFFER_CHAR_CHECK) {
+            return false;
+        }
+        m_checkTrailer = true;
+        m_checkDigits  = 0;
+        m_checkValue   = 0;
+        return true;
+    }
+
+    // remove last digit or '*'
+    if (readChar == m_bsChar) {
+        if (m_checkDigits == 0) {
+            m_checkTrailer = false;
+        } else if (m_checkDigits <= 4) {
+            m_checkValue >>= 4;
+            m_checkDigits--;
+        }
+        return true;
+    }
+
+    if (readChar >= '0' && readChar <= '9') {
+        digit = readChar - '0';
+    } else if (readChar >= 'A' && readChar <= 'F') {
+        digit = readChar - 'A' + 10;
+    } else if (readChar >= 'a' && readChar <= 'f') {
+        digit = readChar - 'a' + 10;
+    } else {
+        // trailer is broken until end of line
+        m_checkDigits = 0xFF;
+        return true;
+    }
+
+    if (m_checkDigits < 4) {
+        m_checkValue = (m_checkValue << 4) | digit;
+        m_checkDigits++;
+    } else {
+        m_checkDigits = 0xFF;
+    }
+    return true;
+}
+
+
+void CmdBufferObject::resetCheck()
+{
+    m_checkTrailer = false;
+    m_checkDigits  = 0;
+    m_checkValue   = 0;
+    m_checkSum     = (m_checkMode == CMDBUFFER_CHECK_CRC16) ? CMDBUFFER_CRC_INIT : 0;
+    m_rewindSize   = 0;
+    m_rewindSum    = m_checkSum;
+}
+
+
+void CmdBufferObject::parseLine()
+{
+    uint8_t *buffer = this->getLineBuffer();
+
+    if (m_parser == NULL) {
+        return;
+    }
+
+    // first character starts the parser again
+    if (m_dataOffset == 0) {
+        m_parser->abortIncremental();
+        return;
+    }
+
+    m_parser->beginIncremental(buffer);
+    for (size_t i = 0; i < m_dataOffset; i++) {
+        m_parser->parseIncremental(i);
+    }
+}
+
+
+void CmdBufferObject::rewindLine(size_t size)
+{
+    if (size < m_dataOffset) {
+        m_dataOffset = size;
+        m_rewindSize = size;
+        m_rewindSum  = m_checkSum;
+        this->parseLine();
+    }
+}
+
+
+void CmdBufferObject::resetFrame()
+{
+    m_dataOffset  = 0;
+    m_frameEscape = false;
+    m_frameDrop   = false;
+    m_frameCrc    = CMDBUFFER_CRC_INIT;
+}
+
+
+void CmdBufferObject::setOptBinary(bool onOff)
+{
+    m_binary         = onOff;
+    m_foundStartChar = 0;
+    this->resetFrame();
+}
+
+
+uint16_t CmdBufferObject::crc16(uint16_t crc, uint8_t data)
+{
+    crc ^= static_cast<uint16_t>(data) << 8;
+
+    // bitwise, no table in flash or ram
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+
+    return crc;
+}
+
+
+#if defined(CMDBUFFER_STATS)
+void CmdBufferObject::printStats(Print *out)
+{
+    if (out == NULL) {
+        return;
+    }
+
+    out->print(F("lines "));
+    out->print(m_stats.lines);
+    out->print(F(" overflows "));
+    out->print(m_stats.overflows);
+    out->print(F(" drops "));
+    out->print(m_stats.drops);
+    out->print(F(" backspaces "));
+    out->print(m_stats.backspaces);
+    out->print(F(" resets "));
+    out->print(m_stats.resets);
+    out->print(F(" crc "));
+    out->println(m_stats.crcErrors);
+}
+#endif
@@ -27,6 +27,76 @@
 #define CMDBUFFER_CHAR_DEL         0x7F
 #define CMDBUFFER_NO_ID            0xFF   // use with setOptID()
 
+// SLIP framing of binary commands @see setOptBinary
+#define CMDBUFFER_SLIP_END         0xC0
+#define CMDBUFFER_SLIP_ESC         0xDB
+#define CMDBUFFER_SLIP_ESC_END     0xDC
+#define CMDBUFFER_SLIP_ESC_ESC     0xDD
+#define CMDBUFFER_CRC_INIT         0xFFFF // @see crc16
+
+// Checksum trailer of text lines @see setOptChecksum
+#define CMDBUFFER_CHECK_NONE       0
+#define CMDBUFFER_CHECK_NMEA       1      // "*HH" XOR of all chars
+#define CMDBUFFER_CHECK_CRC16      2      // "*HHHH" CRC-16 of all chars
+#define CMDBUFFER_CHAR_CHECK       0x2A   // '*' start of trailer
+
+// Count lines, overflows, backspaces and framing resets. Define
+// CMDBUFFER_STATS for all sources, i.e. as compiler flag.
+//#define CMDBUFFER_STATS
+
+class CmdQueueObject;
+class CmdParser;
+
+#if defined(CMDBUFFER_STATS)
+/**
+ * Counters of a buffer object @see CmdBufferObject::getStats.
+ */
+struct CmdBufferStats
+{
+    /** Lines received until end character */
+    uint32_t lines;
+
+    /** Lines dropped because the buffer was full */
+    uint32_t overflows;
+
+    /** Characters dropped with these lines */
+    uint32_t drops;
+
+    /** Backspace characters */
+    uint32_t backspaces;
+
+    /** Frames reset by a wrong start character sequence or device ID */
+    uint32_t resets;
+
+    /** Frames or lines dropped by a wrong CRC, checksum or framing */
+    uint32_t crcErrors;
+};
+#endif
+
+/**
+ * State of a streamed command in the line in receiving
+ * @see CmdBufferObject::getStream.
+ */
+struct CmdBufferStream
+{
+    /** Store number of the command, valid if check is set */
+    size_t cmd;
+
+    /** Cmd word is resolved at the first seperator */
+    bool check;
+
+    /** Number of params handed over and dropped from the line */
+    uint16_t params;
+};
+
+/**
+ * Called by readFromSerial while waiting for data.
+ *
+ * @param serial        Stream waiting for data
+ * @param waitTime      Time in millisec until timeout or 0 for none
+ */
+typedef void (*CmdIdleFunct)(Stream *serial, uint32_t waitTime);
+
 
 /**
  *
@@ -52,6 +122,8 @@ class CmdBufferObject
     /**
      * Read data from serial communication to buffer. It read only printable
      * ASCII character from serial. All other will ignore for buffer.
+     * While waiting for data, the idle function is called or yield() if
+     * none is set @see setIdleFunct.
      *
      * @param serial        Arduino Serial object from read commands
      * @param timeOut       Set a time out in millisec or 0 for none
@@ -72,6 +144,40 @@ class CmdBufferObject
      */
     bool readSerialChar(Stream *serial);
 
+    /**
+     * Read all currently available data from serial communication to buffer
+     * with a single Stream::readBytesUntil call. Reading stops after the end
+     * character, so following commands stay in the serial input buffer.
+     * It read only printable ASCII character from serial.
+     *
+     * @param serial        Arduino Serial object from read commands
+     * @return              TRUE if data readed until end character or
+     *                      FALSE if not.
+     */
+    bool readSerialBlock(Stream *serial);
+
+    /**
+     * Read data from memory to buffer, i.e. from a DMA or interrupt buffer.
+     * Reading stops after the end character. No echo is written.
+     *
+     * @param data          Data to read
+     * @param size          Size of data
+     * @param count         Optional, return number of bytes readed
+     * @return              TRUE if data readed until end character or
+     *                      FALSE if not.
+     */
+    bool readChars(const uint8_t *data, size_t size, size_t *count = NULL);
+
+    /**
+     * Read data from a queue, filled by a interrupt or reader thread.
+     * Reading stops after the end character. No echo is written.
+     *
+     * @param queue         Queue with received data
+     * @return              TRUE if data readed until end character or
+     *                      FALSE if not.
+     */
+    bool readFromQueue(CmdQueueObject *queue);
+
     /**
      * Set a ASCII character for serial cmd end.
      * Default value is LF.
@@ -130,6 +236,81 @@ class CmdBufferObject
      */
     void setOptID(uint8_t id) { m_ID = id; }
 
+    /**
+     * Set a function called by readFromSerial while waiting for data,
+     * i.e. to sleep until a interrupt or to poll() a file descriptor.
+     * It should return when data is available or the wait time is over.
+     * Default is NULL, then yield() is called.
+     *
+     * @param idleFunct       Function or NULL
+     */
+    void setIdleFunct(CmdIdleFunct idleFunct) { m_idleFunct = idleFunct; }
+
+    /**
+     * Set buffer option for a checksum trailer of each line, i.e.
+     * "$led on*4F" with NMEA. The checksum is in hex of all stored chars
+     * before '*', start characters and device ID are not included. The
+     * trailer is checked while receiving and not stored, lines with a
+     * wrong or missing trailer are dropped. Default is off
+     *
+     * Modes are:
+     * - CMDBUFFER_CHECK_NONE
+     * - CMDBUFFER_CHECK_NMEA      XOR as "*HH"
+     * - CMDBUFFER_CHECK_CRC16     CRC-16 @see crc16 as "*HHHH"
+     *
+     * @param mode            Checksum mode
+     */
+    void setOptChecksum(uint8_t mode) { m_checkMode = mode; this->resetCheck(); }
+
+    /**
+     * Get mode of checksum trailer @see setOptChecksum.
+     *
+     * @return                Checksum mode
+     */
+    uint8_t getOptChecksum() { return m_checkMode; }
+
+    /**
+     * Set buffer option for binary frames instead of text lines.
+     * Default is off
+     *
+     * A frame is SLIP encoded, ends with CMDBUFFER_SLIP_END and holds
+     * the payload and a CRC-16 of it, high byte first. Frames with a wrong
+     * CRC are dropped. Start character, device ID, backspace and echo are
+     * not used. Payload is parsed by CmdParser::parseBinary, write frames
+     * with CmdFrame.
+     *
+     * @param onOff           Set option TRUE (on) or FALSE (off)
+     */
+    void setOptBinary(bool onOff = true);
+
+    /**
+     * Check if buffer receives binary frames @see setOptBinary.
+     *
+     * @return                TRUE for binary frames
+     */
+    bool isBinary() { return m_binary; }
+
+    /**
+     * Update a CRC-16/CCITT with one byte, start with CMDBUFFER_CRC_INIT.
+     * A CRC over data and its CRC, high byte first, is 0.
+     *
+     * @param crc             CRC of data before
+     * @param data            Next byte
+     * @return                CRC with byte
+     */
+    static uint16_t crc16(uint16_t crc, uint8_t data);
+
+    /**
+     * Parse the line while receiving. Each stored character is handed to
+     * the parser, so CmdParser::parseCmd only terminates the words at the
+     * end of line. A line with backspace or a moved line is parsed again.
+     * Results of the parser are valid until the next character is read.
+     * Default is NULL (off)
+     *
+     * @param cmdParser       Parser for the lines of this buffer
+     */
+    void setParser(CmdParser *cmdParser) { m_parser = cmdParser; }
+
     /**
      * Set echo serial on (true) or off (false)
      *
@@ -166,7 +347,154 @@ class CmdBufferObject
      */
     virtual size_t getBufferSize() = 0;
 
+    /**
+     * Get size of the complete line in buffer without the '\0' at the end.
+     *
+     * @return              Size of data or 0 if no complete line
+     */
+    virtual size_t getDataSize() { return m_dataSize; }
+
+    /**
+     * Get the line in receiving, i.e. to process a long line in parts
+     * @see rewindLine.
+     *
+     * @param size          Size of received data
+     * @return              Buffer of line
+     */
+    uint8_t *getLine(size_t *size)
+    {
+        *size = m_dataOffset;
+        return this->getLineBuffer();
+    }
+
+    /**
+     * Drop the received data of the line behind SIZE. The parser parses
+     * the rest again @see setParser. A backspace can't remove the kept
+     * data anymore and a checksum trailer still covers the whole line.
+     *
+     * @param size          Size of data to keep
+     */
+    void rewindLine(size_t size);
+
+    /**
+     * Get state of a streamed command of the line in receiving, it is
+     * kept by CmdCallbackObject::updateCmdProcessing for each buffer.
+     *
+     * @return              State of this buffer
+     */
+    CmdBufferStream *getStream() { return &m_stream; }
+
+#if defined(CMDBUFFER_STATS)
+    /**
+     * Get counters since start or last clearStats.
+     *
+     * @return              Counters of this buffer
+     */
+    const CmdBufferStats *getStats() { return &m_stats; }
+
+    /**
+     * Reset all counters to 0.
+     */
+    void clearStats() { memset(&m_stats, 0x00, sizeof(m_stats)); }
+
+    /**
+     * Print all counters in one line.
+     *
+     * @param out           Output for counters, i.e. Serial
+     */
+    void printStats(Print *out);
+#endif
+
+  protected:
+    /**
+     * Get the buffer for storing the received line.
+     * Default is the same as getBuffer.
+     *
+     * @return              Buffer for received data
+     */
+    virtual uint8_t *getLineBuffer() { return this->getBuffer(); }
+
+    /**
+     * Get size of the buffer for storing the received line, without the
+     * byte for '\0'. Default is the same as getBufferSize.
+     *
+     * @return              Size of line buffer
+     */
+    virtual size_t getLineSize() { return this->getBufferSize(); }
+
+    /**
+     * Called if the received line fills the line buffer.
+     * Default drops the line.
+     *
+     * @param size          Size of received line
+     * @return              TRUE if line buffer has room now or FALSE to drop
+     *                      the line
+     */
+    virtual bool lineFull(size_t /* size */) { return false; }
+
+    /**
+     * Called after a complete line was stored with '\0' at the end.
+     *
+     * @param size          Size of received line
+     */
+    virtual void lineEnd(size_t /* size */) {}
+
+    /**
+     * Reset size of the complete line for clear. Get how many bytes of
+     * the line buffer was written since last call, bytes behind are
+     * untouched since last clear.
+     *
+     * @return              Number of written bytes
+     */
+    size_t clearLine()
+    {
+        size_t used = m_usedSize;
+        m_usedSize  = m_dataOffset;
+        m_dataSize  = 0;
+        return used;
+    }
+
   private:
+    /**
+     * Handle a received char with start, ID, end and backspace characters.
+     *
+     * @param readChar      Received char
+     * @param serial        Serial for echo or NULL
+     * @return              TRUE if char was the end character
+     */
+    bool storeChar(uint8_t readChar, Stream *serial);
+
+    /**
+     * Handle a received byte of a binary frame.
+     *
+     * @param readChar      Received byte
+     * @return              TRUE if a valid frame ends with this byte
+     */
+    bool storeFrame(uint8_t readChar);
+
+    /**
+     * Start a new binary frame.
+     */
+    void resetFrame();
+
+    /**
+     * Handle a char of a checksum trailer.
+     *
+     * @param readChar      Received char
+     * @return              TRUE if char is part of the trailer
+     */
+    bool storeCheck(uint8_t readChar);
+
+    /**
+     * Start checksum of a new line, nothing is kept by rewindLine.
+     */
+    void resetCheck();
+
+    /**
+     * Hand the received data of the line to the parser again.
+     */
+    void parseLine();
+
     /** Character for handling the end of serial data communication */
     uint8_t m_endChar;
     uint8_t m_bsChar;
@@ -175,8 +503,41 @@ class CmdBufferObject
     uint8_t m_ID;
     uint8_t m_foundStartChar;
     size_t  m_dataOffset;
+    size_t  m_usedSize;
+    size_t  m_dataSize;
     bool    m_echo;
 
+    /** State of binary frames @see setOptBinary */
+    bool     m_binary;
+    bool     m_frameEscape;
+    bool     m_frameDrop;
+    uint16_t m_frameCrc;
+
+    /** State of line checksum @see setOptChecksum */
+    uint8_t  m_checkMode;
+    bool     m_checkTrailer;
+    uint8_t  m_checkDigits;
+    uint16_t m_checkSum;
+    uint16_t m_checkValue;
+
+    /** Size of data kept by rewindLine and checksum of dropped data */
+    size_t   m_rewindSize;
+    uint16_t m_rewindSum;
+
+    /** Streamed command of the line in receiving @see getStream */
+    CmdBufferStream m_stream;
+
+    /** Parser of received characters @see setParser */
+    CmdParser *m_parser;
+
+    /** Function for waiting on data @see setIdleFunct */
+    CmdIdleFunct m_idleFunct;
+
+#if defined(CMDBUFFER_STATS)
+    /** Counters @see getStats */
+    CmdBufferStats m_stats;
+#endif
+
 };
 
 /**
@@ -190,12 +551,13 @@ class CmdBuffer : public CmdBufferObject
     /**
      * Cleanup Buffers
      */
-    CmdBuffer() { this->clear(); }
+    CmdBuffer() { memset(m_buffer, 0x00, BUFFERSIZE + 1); }
 
     /**
+     * Clear only the written part of buffer and the '\0' behind.
      * @interface CmdBufferObject
      */
-    virtual void clear() { memset(m_buffer, 0x00, BUFFERSIZE + 1); }
+    virtual void clear() { memset(m_buffer, 0x00, this->clearLine() + 1); }
 
     /**
      * @interface CmdBufferObject
@@ -212,4 +574,186 @@ class CmdBuffer : public CmdBufferObject
     uint8_t m_buffer[BUFFERSIZE + 1];
 };
 
+/**
+ * Buffer for a queue of command lines. Received data is stored in a ring
+ * while older complete lines wait for parsing. getBuffer return the
+ * oldest complete line and clear remove it from queue.
+ * Lines are not copied, a partial line is only moved once to the front if
+ * it reach the end of ring. Every line has a header with the line size.
+ */
+template <size_t BUFFERSIZE>
+class CmdRingBuffer : public CmdBufferObject
+{
+  public:
+    /**
+     * Cleanup Buffers
+     */
+    CmdRingBuffer()
+        : m_readPos(0), m_writePos(0), m_wrapPos(0), m_lineCount(0),
+          m_wrapped(false)
+    {
+        memset(m_ring, 0x00, RINGSIZE + 1);
+    }
+
+    /**
+     * Remove the oldest complete line from queue.
+     * @interface CmdBufferObject
+     */
+    virtual void clear()
+    {
+        size_t size;
+
+        if (m_lineCount == 0) {
+            return;
+        }
+
+        memcpy(&size, &m_ring[m_readPos], HEADERSIZE);
+        m_readPos += HEADERSIZE + size + 1;
+        m_lineCount--;
+
+        // oldest line is at front of ring
+        if (m_wrapped && m_readPos >= m_wrapPos) {
+            m_readPos = 0;
+            m_wrapped = false;
+        }
+    }
+
+    /**
+     * Return the oldest complete line or a empty string.
+     * @interface CmdBufferObject
+     */
+    virtual uint8_t *getBuffer()
+    {
+        if (m_lineCount == 0) {
+            return &m_ring[RINGSIZE];
+        }
+        return &m_ring[m_readPos + HEADERSIZE];
+    }
+
+    /**
+     * @interface CmdBufferObject
+     */
+    virtual size_t getBufferSize() { return BUFFERSIZE; }
+
+    /**
+     * Return size of the oldest complete line.
+     * @interface CmdBufferObject
+     */
+    virtual size_t getDataSize()
+    {
+        size_t size = 0;
+
+        if (m_lineCount != 0) {
+            memcpy(&size, &m_ring[m_readPos], HEADERSIZE);
+        }
+        return size;
+    }
+
+    /**
+     * Get number of complete lines in queue.
+     *
+     * @return              Number of lines
+     */
+    size_t getLineCount() { return m_lineCount; }
+
+  protected:
+    /**
+     * @interface CmdBufferObject
+     */
+    virtual uint8_t *getLineBuffer() { return &m_ring[m_writePos + HEADERSIZE]; }
+
+    /**
+     * @interface CmdBufferObject
+     */
+    virtual size_t getLineSize()
+    {
+        // free space up to oldest line
+        if (m_wrapped) {
+            if (m_readPos > m_writePos + HEADERSIZE + 1) {
+                return m_readPos - m_writePos - HEADERSIZE - 1;
+            }
+            return 0;
+        }
+
+        // free space up to end of ring
+        if (m_writePos + HEADERSIZE < RINGSIZE) {
+            return RINGSIZE - m_writePos - HEADERSIZE - 1;
+        }
+        return 0;
+    }
+
+    /**
+     * Move the partial line to front of ring.
+     * @interface CmdBufferObject
+     */
+    virtual bool lineFull(size_t size)
+    {
+        if (m_wrapped || m_writePos == 0) {
+            return false;
+        }
+
+        // queue is empty, so whole ring is free
+        if (m_lineCount == 0) {
+            m_readPos = 0;
+        }
+        // need free space up to oldest line
+        else if (m_readPos <= HEADERSIZE + size + 1) {
+            return false;
+        }
+        else {
+            m_wrapPos = m_writePos;
+            m_wrapped = true;
+        }
+
+        memmove(&m_ring[HEADERSIZE], &m_ring[m_writePos + HEADERSIZE], size);
+        m_writePos = 0;
+        return true;
+    }
+
+    /**
+     * Add the line to queue, empty lines are dropped.
+     * @interface CmdBufferObject
+     */
+    virtual void lineEnd(size_t size)
+    {
+        // a empty line can't be parsed, so it is never removed by clear
+        if (size == 0) {
+            return;
+        }
+
+        if (m_lineCount == 0) {
+            m_readPos = m_writePos;
+        }
+
+        memcpy(&m_ring[m_writePos], &size, HEADERSIZE);
+        m_writePos += HEADERSIZE + size + 1;
+        m_lineCount++;
+    }
+
+  private:
+    /** Size of line header */
+    static const size_t HEADERSIZE = sizeof(size_t);
+
+    /** Size of ring, a line of BUFFERSIZE fits in */
+    static const size_t RINGSIZE = BUFFERSIZE + HEADERSIZE + 1;
+
+    /** Ring for reading data, last byte is a empty string */
+    uint8_t m_ring[RINGSIZE + 1];
+
+    /** Start of oldest complete line */
+    size_t m_readPos;
+
+    /** Start of receiving line */
+    size_t m_writePos;
+
+    /** End of lines at the back of ring, if receiving line was moved */
+    size_t m_wrapPos;
+
+    /** Number of complete lines */
+    size_t m_lineCount;
+
+    /** Receiving line is in front of oldest line */
+    bool m_wrapped;
+};
+
 #endif
@@ -16,36 +16,117 @@ void CmdCallbackObject::loopCmdProcessing(CmdParser *      cmdParser,
 
             // parse command line
             if (cmdParser->parseCmd(cmdBuffer) != CMDPARSER_ERROR) {
-                // search command in store and call function
-                // ignore return value "false" if command was not found
-                this->processCmd(cmdParser);
-                cmdBuffer->clear();
+                // search commands in store and call functions
+                // commands not found are ignored
+                this->processCmds(cmdParser, serial, cmdBuffer);
             }
+
+            // remove also empty or broken lines from buffer
+            cmdBuffer->clear();
         }
     } while (true);
 }
 
 bool CmdCallbackObject::processCmd(CmdParser *cmdParser)
 {
-    char *cmdStr = cmdParser->getCommand();
+    CmdParserView cmdView = cmdParser->getCommandView();
+    size_t        idx;
 
     // check is commando okay
-    if (cmdStr == NULL) {
+    if (cmdView.str == NULL) {
         return false;
     }
 
-    // search cmd in store
-    for (size_t i = 0; this->checkStorePos(i); i++) {
+#if defined(CMDCALLBACK_STATS)
+    m_processedCount++;
+#endif
 
-        // compare command with string
-        if (this->equalStoreCmd(i, cmdStr)) {
-            // call function
-            return this->callStoreFunct(i, cmdParser);
+    // search cmd in store, cmd is not terminated with keep buffer
+    idx = this->findStoreCmd(cmdView.str, cmdView.size);
+    if (idx == CMDCALLBACK_NO_CMD) {
+#if defined(CMDCALLBACK_STATS)
+        m_unknownCount++;
+#endif
+        return false;
+    }
+
+    // call function
+    return this->callStoreFunct(idx, cmdParser);
+}
+
+size_t CmdCallbackObject::processCmds(CmdParser *      cmdParser,
+                                      Print *          out,
+                                      CmdBufferObject *cmdBuffer)
+{
+    size_t found = 0;
+
+    // dispatch each command of the batch
+    for (uint16_t i = 0; i < cmdParser->getCmdCount(); i++) {
+        cmdParser->selectCmd(i);
+
+        // params of a line in receiving are streamed to the first command
+        m_streamBase = 0;
+        if (i == 0 && cmdBuffer != NULL && cmdBuffer->getStream()->check) {
+            m_streamBase = cmdBuffer->getStream()->params;
         }
+
+#if defined(CMDCALLBACK_STATS)
+        // built-in command, if not in store
+        if (out != NULL && cmdParser->equalCommand(CMDCALLBACK_STATS_CMD) &&
+            this->findStoreCmd(CMDCALLBACK_STATS_CMD) == CMDCALLBACK_NO_CMD) {
+            this->printStats(out);
+#if defined(CMDBUFFER_STATS)
+            if (cmdBuffer != NULL) {
+                cmdBuffer->printStats(out);
+            }
+#endif
+            found++;
+            continue;
+        }
+#else
+        (void)out;
+#endif
+
+        if (this->processCmd(cmdParser)) {
+            found++;
+        }
+    }
+
+    m_streamBase = 0;
+    return found;
+}
+
+#if defined(CMDCALLBACK_STATS)
+void CmdCallbackObject::printStats(Print *out)
+{
+    const CmdCallbackStats *stats;
+
+    if (out == NULL) {
+        return;
     }
 
-    return false;
+    out->print(F("cmds "));
+    out->print(m_processedCount);
+    out->print(F(" unknown "));
+    out->println(m_unknownCount);
+
+    // one line for each command in store
+    for (size_t i = 0; this->checkStorePos(i); i++) {
+        stats = this->getStoreStats(i);
+        if (stats == NULL) {
+            continue;
+        }
+
+        this->printStoreCmd(i, out);
+        out->print(F(" hits "));
+        out->print(stats->hits);
+        out->print(F(" time "));
+        out->print(stats->totalTime);
+        out->print(F(" max "));
+        out->println(stats->maxTime);
+    }
 }
+#endif
 
 void CmdCallbackObject::updateCmdProcessing(CmdParser *      cmdParser,
                                             CmdBufferObject *cmdBuffer,
@@ -55,24 +136,222 @@ void CmdCallbackObject::updateCmdProcessing(CmdParser *      cmdParser,
     if (cmdBuffer->readSerialChar(serial)) {
         // parse command line
         if (cmdParser->parseCmd(cmdBuffer) != CMDPARSER_ERROR) {
-            // search command in store and call function
-            // ignore return value "false" if command was not found
-            this->processCmd(cmdParser);
-            cmdBuffer->clear();
+            // search commands in store and call functions
+            // commands not found are ignored
+            this->processCmds(cmdParser, serial, cmdBuffer);
+        }
+
+        // remove also empty or broken lines from buffer
+        cmdBuffer->clear();
+        memset(cmdBuffer->getStream(), 0x00, sizeof(CmdBufferStream));
+    } else {
+        this->streamCmd(cmdParser, cmdBuffer);
+    }
+}
+
+void CmdCallbackObject::streamCmd(CmdParser *      cmdParser,
+                                  CmdBufferObject *cmdBuffer)
+{
+    CmdParserView    cmdView = cmdParser->getIncrementalCommand();
+    CmdBufferStream *stream  = cmdBuffer->getStream();
+    uint16_t         words;
+    uint8_t *        line;
+    size_t           size;
+    size_t           keep;
+    uint8_t          open  = 0x00;
+    uint8_t          close = 0x00;
+
+    // cmd word is not received, new line
+    if (cmdView.str == NULL) {
+        memset(stream, 0x00, sizeof(CmdBufferStream));
+        return;
+    }
+
+    // params of a line with checksum are handled after it is verified
+    if (cmdBuffer->getOptChecksum() != CMDBUFFER_CHECK_NONE) {
+        return;
+    }
+
+    words = cmdParser->getIncrementalWords();
+    if (words == 0) {
+        return;
+    }
+
+    // resolve cmd word at first seperator
+    if (!stream->check) {
+        stream->check = true;
+        stream->cmd   = this->findStoreCmd(cmdView.str, cmdView.size);
+    }
+    if (!this->isStoreStream(stream->cmd)) {
+        return;
+    }
+
+    // cmd word in quotes or parens, the parser removes them
+    line = cmdBuffer->getLine(&size);
+    keep = cmdView.size + 1;
+    if (cmdView.str > reinterpret_cast<char *>(line) &&
+        cmdView.str[-1] != cmdParser->getOptSeperator()) {
+        open  = cmdView.str[-1];
+        close = cmdView.str[cmdView.size];
+        keep += 2;
+    }
+    if (keep >= size) {
+        return;
+    }
+
+    // hand params to stream function
+    if (words > 1) {
+        cmdParser->parseCmd(line, size);
+        for (uint16_t i = 1; i <= cmdParser->getParamCount(); i++) {
+            this->callStreamFunct(stream->cmd, cmdParser, i,
+                                  stream->params + i);
         }
+        stream->params += cmdParser->getParamCount();
+    }
+
+    // keep cmd word and a seperator
+    keep = 0;
+    if (open != 0x00) {
+        line[keep++] = open;
+    }
+    memmove(&line[keep], cmdView.str, cmdView.size);
+    keep += cmdView.size;
+    if (open != 0x00) {
+        line[keep++] = close;
     }
+    line[keep++] = cmdParser->getOptSeperator();
+    cmdBuffer->rewindLine(keep);
 }
 
 bool CmdCallbackObject::hasCmd(char *cmdStr)
+{
+    return this->findStoreCmd(cmdStr) != CMDCALLBACK_NO_CMD;
+}
+
+size_t CmdCallbackObject::findStoreCmd(const char *cmdStr, size_t size)
 {
     // search cmd in store
     for (size_t i = 0; this->checkStorePos(i); i++) {
 
         // compare command with string
-        if (this->equalStoreCmd(i, cmdStr)) {
-            return true;
+        if (this->equalStoreCmd(i, cmdStr, size)) {
+            return i;
+        }
+    }
+
+    return CMDCALLBACK_NO_CMD;
+}
+
+uint16_t CmdCallbackObject::hashCmd(const char *cmdStr, size_t size)
+{
+    uint16_t hash = 5381;
+
+    // case folded, so "CMD" and "cmd" give the same hash
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash * 33) ^ tolower(static_cast<uint8_t>(cmdStr[i]));
+    }
+
+    return hash;
+}
+
+void CmdCallbackTable::loopCmdProcessing(CmdParser *      cmdParser,
+                                         CmdBufferObject *cmdBuffer,
+                                         Stream *         serial) const
+{
+    do {
+        // read data
+        if (cmdBuffer->readFromSerial(serial)) {
+
+            // parse command line
+            if (cmdParser->parseCmd(cmdBuffer) != CMDPARSER_ERROR) {
+                // search commands in table and call functions
+                this->processCmds(cmdParser);
+            }
+
+            // remove also empty or broken lines from buffer
+            cmdBuffer->clear();
+        }
+    } while (true);
+}
+
+void CmdCallbackTable::updateCmdProcessing(CmdParser *      cmdParser,
+                                           CmdBufferObject *cmdBuffer,
+                                           Stream *         serial) const
+{
+    // read data and check if command was entered
+    if (cmdBuffer->readSerialChar(serial)) {
+        // parse command line
+        if (cmdParser->parseCmd(cmdBuffer) != CMDPARSER_ERROR) {
+            // search commands in table and call functions
+            this->processCmds(cmdParser);
+        }
+
+        // remove also empty or broken lines from buffer
+        cmdBuffer->clear();
+    }
+}
+
+bool CmdCallbackTable::processCmd(CmdParser *cmdParser) const
+{
+    CmdParserView cmdView = cmdParser->getCommandView();
+    size_t        idx;
+
+    // check is commando okay
+    if (cmdView.str == NULL) {
+        return false;
+    }
+
+    // search cmd in table, cmd is not terminated with keep buffer
+    idx = this->findStoreCmd(cmdView.str, cmdView.size);
+    if (idx == CMDCALLBACK_NO_CMD || m_table[idx].cbFunct == NULL) {
+        return false;
+    }
+
+    // call function
+    m_table[idx].cbFunct(cmdParser);
+    return true;
+}
+
+size_t CmdCallbackTable::processCmds(CmdParser *cmdParser) const
+{
+    size_t found = 0;
+
+    // dispatch each command of the batch
+    for (uint16_t i = 0; i < cmdParser->getCmdCount(); i++) {
+        cmdParser->selectCmd(i);
+        if (this->processCmd(cmdParser)) {
+            found++;
+        }
+    }
+
+    return found;
+}
+
+size_t CmdCallbackTable::findStoreCmd(const char *cmdStr, size_t size) const
+{
+    size_t first = 0;
+    size_t last  = m_size;
+    size_t mid;
+    int    cmp;
+
+    // binary search in sorted table
+    while (first < last) {
+        mid = first + (last - first) / 2;
+        cmp = strncasecmp(cmdStr, m_table[mid].cmdStr, size);
+
+        // same start, a longer command is behind
+        if (cmp == 0 && m_table[mid].cmdStr[size] != 0x00) {
+            cmp = -1;
+        }
+
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            last = mid;
+        } else {
+            first = mid + 1;
         }
     }
 
-    return false;
+    return CMDCALLBACK_NO_CMD;
 }
@@ -21,8 +21,60 @@
 #include "CmdBuffer.h"
 #include "CmdParser.h"
 
+#define CMDCALLBACK_NO_CMD      ((size_t)~0)  // @see findStoreCmd
+
+// Stores up to this size are searched linear by CmdCallbackHash
+#ifndef CMDCALLBACK_HASH_MIN
+#define CMDCALLBACK_HASH_MIN    8
+#endif
+
+// Count commands and handler time in micros. Define CMDCALLBACK_STATS for
+// all sources, i.e. as compiler flag.
+//#define CMDCALLBACK_STATS
+
+// Built-in command of the processing functions to print all counters
+#ifndef CMDCALLBACK_STATS_CMD
+#define CMDCALLBACK_STATS_CMD   "stats"
+#endif
+
 typedef void (*CmdCallFunct)(CmdParser *cmdParser);
 
+// Handler of a streamed command, called with each param number IDX in the
+// parser and its number PARAM in the whole command, counted over all parts
+// of the line. At the end of the command IDX is 0 and PARAM the number of
+// params @see _CmdCallback::addStreamCmd
+typedef void (*CmdStreamFunct)(CmdParser *cmdParser, uint16_t idx,
+                               uint16_t param);
+
+#if defined(CMDCALLBACK_STATS)
+/**
+ * Counters of a command in store @see CmdCallbackObject::getStoreStats.
+ */
+struct CmdCallbackStats
+{
+    /** Number of calls */
+    uint32_t hits;
+
+    /** Sum and maximum of handler time in micros */
+    uint32_t totalTime;
+    uint32_t maxTime;
+};
+#endif
+
+/**
+ * Compare a cmd string in store with a string of SIZE case insensitive,
+ * the string must not be terminated with '\0'.
+ *
+ * @param cmdStr            Cmd string in store
+ * @param str               String to compare
+ * @param size              Size of string
+ * @return                  TRUE is equal
+ */
+inline bool cmdCallbackEqual(const char *cmdStr, const char *str, size_t size)
+{
+    return strncasecmp(cmdStr, str, size) == 0 && cmdStr[size] == 0x00;
+}
+
 /**
  *
  *
@@ -30,6 +82,19 @@ typedef void (*CmdCallFunct)(CmdParser *cmdParser);
 class CmdCallbackObject
 {
   public:
+    /**
+     * Cleanup counters
+     */
+    CmdCallbackObject()
+        : m_streamBase(0)
+#if defined(CMDCALLBACK_STATS)
+          ,
+          m_processedCount(0),
+          m_unknownCount(0)
+#endif
+    {
+    }
+
     /**
      * Endless loop for process incoming data from serial.
      *
@@ -49,7 +114,29 @@ class CmdCallbackObject
     virtual bool processCmd(CmdParser *cmdParser);
 
     /**
-     * Check for single new char on serial and if it was the endChar
+     * Execute the callback function of each command of a parsed batch
+     * back to back @see CmdParser::setOptCmdDelimiter.
+     * With CMDCALLBACK_STATS the built-in command CMDCALLBACK_STATS_CMD
+     * prints all counters to OUT, if it is not in the store.
+     *
+     * @param cmdParser         Parser with parsed command line
+     * @param out               Optional, output for built-in command
+     * @param cmdBuffer         Optional, buffer of the line to print counters
+     *                          and to number streamed params
+     * @return                  Number of commands found in the buffer
+     */
+    size_t processCmds(CmdParser *cmdParser, Print *out = NULL,
+                       CmdBufferObject *cmdBuffer = NULL);
+
+    /**
+     * Check for single new char on serial and if it was the endChar.
+     * If the buffer parses while receiving @see CmdBufferObject::setParser,
+     * a streamed command is resolved at the first seperator and each
+     * complete param is handed to the handler and dropped from the buffer.
+     * With a checksum trailer @see CmdBufferObject::setOptChecksum, params
+     * are handed only at the end of a verified line.
+     * The state of streaming is kept in the buffer, so the object can serve
+     * many buffers @see CmdBufferObject::getStream.
      *
      * @param cmdParser         Parser object with options set
      * @param cmdBuffer         Buffer object for data handling
@@ -66,6 +153,36 @@ class CmdCallbackObject
      */
     virtual bool hasCmd(char *cmdStr);
 
+    /**
+     * Search the store number of a command.
+     *
+     * @param cmdStr            Cmd string to search
+     * @return                  Store number or CMDCALLBACK_NO_CMD
+     */
+    size_t findStoreCmd(const char *cmdStr)
+    {
+        return this->findStoreCmd(cmdStr, strlen(cmdStr));
+    }
+
+    /**
+     * Search the store number of a command, the string must not be
+     * terminated with '\0' @see CmdParser::getCommandView.
+     *
+     * @param cmdStr            Cmd string to search
+     * @param size              Size of cmd string
+     * @return                  Store number or CMDCALLBACK_NO_CMD
+     */
+    virtual size_t findStoreCmd(const char *cmdStr, size_t size);
+
+    /**
+     * Calc a case insensitive hash from cmd string.
+     *
+     * @param cmdStr            Cmd string
+     * @param size              Size of cmd string
+     * @return                  Hash value
+     */
+    static uint16_t hashCmd(const char *cmdStr, size_t size);
+
     /**
      * Give the size of callback store.
      *
@@ -87,9 +204,11 @@ class CmdCallbackObject
      *
      * @param idx               Store number
      * @param cmdStr            Cmd string to search
+     * @param size              Size of cmd string
      * @return                  TRUE is equal
      */
-    virtual bool equalStoreCmd(size_t idx, char *cmdStr) = 0;
+    virtual bool equalStoreCmd(size_t idx, const char *cmdStr,
+                               size_t size) = 0;
 
     /**
      * Call function from store.
@@ -99,6 +218,99 @@ class CmdCallbackObject
      * @return                  TRUE if function is valid and calling
      */
     virtual bool callStoreFunct(size_t idx, CmdParser *cmdParser) = 0;
+
+    /**
+     * Check if the command on store idx is streamed.
+     *
+     * @param idx               Store number
+     * @return                  TRUE if command has a CmdStreamFunct
+     */
+    virtual bool isStoreStream(size_t /* idx */) { return false; }
+
+    /**
+     * Call the stream function from store with a param.
+     * Please check idx with @see isStoreStream befor you use this funct!
+     *
+     * @param idx               Store number
+     * @param param             Param number or 0 for end of command
+     * @param count             Number of param in command, or number of
+     *                          params at the end
+     * @return                  TRUE if function is valid and calling
+     */
+    virtual bool callStreamFunct(size_t /* idx */, CmdParser * /* cmdParser */,
+                                 uint16_t /* param */, uint16_t /* count */)
+    {
+        return false;
+    }
+
+#if defined(CMDCALLBACK_STATS)
+    /**
+     * Get number of processed and unknown commands.
+     *
+     * @return                  Number of commands
+     */
+    uint32_t getProcessedCount() { return m_processedCount; }
+    uint32_t getUnknownCount() { return m_unknownCount; }
+
+    /**
+     * Get counters of a command in store.
+     *
+     * @param idx               Store number
+     * @return                  Counters or NULL if not exists
+     */
+    virtual const CmdCallbackStats *getStoreStats(size_t /* idx */)
+    {
+        return NULL;
+    }
+
+    /**
+     * Reset all counters to 0.
+     */
+    virtual void clearStats()
+    {
+        m_processedCount = 0;
+        m_unknownCount   = 0;
+    }
+
+    /**
+     * Print all counters, one line for each command in store.
+     *
+     * @param out               Output for counters, i.e. Serial
+     */
+    void printStats(Print *out);
+
+  protected:
+    /**
+     * Print cmd string of a command in store.
+     *
+     * @param idx               Store number
+     * @param out               Output for cmd string
+     */
+    virtual void printStoreCmd(size_t idx, Print *out) { out->print(idx); }
+#endif
+
+  protected:
+    /**
+     * Number of params streamed before the end of line for the command in
+     * dispatch @see processCmds.
+     */
+    uint16_t m_streamBase;
+
+  private:
+    /**
+     * Hand the complete params of the line in receiving to a streamed
+     * command and drop them from the buffer.
+     *
+     * @param cmdParser         Parser of the buffer
+     * @param cmdBuffer         Buffer with line in receiving
+     */
+    void streamCmd(CmdParser *cmdParser, CmdBufferObject *cmdBuffer);
+
+#if defined(CMDCALLBACK_STATS)
+    /** Number of processed and unknown commands */
+    uint32_t m_processedCount;
+    uint32_t m_unknownCount;
+#endif
 };
 
 /**
@@ -116,6 +328,10 @@ class _CmdCallback : public CmdCallbackObject
     {
         memset(m_cmdList, 0x00, sizeof(PGM_P) * STORESIZE);
         memset(m_functList, 0x00, sizeof(CmdCallFunct) * STORESIZE);
+        memset(m_streamFunctList, 0x00, sizeof(m_streamFunctList));
+#if defined(CMDCALLBACK_STATS)
+        memset(m_statsList, 0x00, sizeof(m_statsList));
+#endif
     }
 
     /**
@@ -125,7 +341,7 @@ class _CmdCallback : public CmdCallbackObject
      * @param cbFunct           A callback function to process your things
      * @return                  TRUE if you have space in buffer of object
      */
-    bool addCmd(T cmdStr, CmdCallFunct cbFunct)
+    virtual bool addCmd(T cmdStr, CmdCallFunct cbFunct)
     {
         // Store is full
         if (m_nextElement >= STORESIZE) {
@@ -140,6 +356,32 @@ class _CmdCallback : public CmdCallbackObject
         return true;
     }
 
+    /**
+     * Link a stream function to command. The function is called with each
+     * param and with 0 at the end of the command, so a long command is
+     * handled before the whole line is received
+     * @see CmdCallbackObject::updateCmdProcessing.
+     * Only updateCmdProcessing streams params, loopCmdProcessing, CmdMux
+     * and buffers with a checksum trailer call the function at the end of
+     * the line, so the line must fit in the buffer.
+     *
+     * @param cmdStr            A cmd string
+     * @param streamFunct       A stream function to process your things
+     * @return                  TRUE if you have space in buffer of object
+     */
+    bool addStreamCmd(T cmdStr, CmdStreamFunct streamFunct)
+    {
+        size_t idx = m_nextElement;
+
+        // store without call function
+        if (streamFunct == NULL || !this->addCmd(cmdStr, NULL)) {
+            return false;
+        }
+
+        m_streamFunctList[idx] = streamFunct;
+        return true;
+    }
+
     /**
      * @implement CmdCallbackObject
      */
@@ -162,23 +404,116 @@ class _CmdCallback : public CmdCallbackObject
      */
     virtual bool callStoreFunct(size_t idx, CmdParser *cmdParser)
     {
-        if (idx < STORESIZE && m_functList[idx] != NULL) {
-            m_functList[idx](cmdParser);
+        if (idx < STORESIZE &&
+            (m_functList[idx] != NULL || m_streamFunctList[idx] != NULL)) {
+#if defined(CMDCALLBACK_STATS)
+            uint32_t time = micros();
+            this->callFunct(idx, cmdParser);
+            time = micros() - time;
+
+            m_statsList[idx].hits++;
+            m_statsList[idx].totalTime += time;
+            if (time > m_statsList[idx].maxTime) {
+                m_statsList[idx].maxTime = time;
+            }
+#else
+            this->callFunct(idx, cmdParser);
+#endif
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @implement CmdCallbackObject
+     */
+    virtual bool isStoreStream(size_t idx)
+    {
+        return idx < STORESIZE && m_streamFunctList[idx] != NULL;
+    }
+
+    /**
+     * @implement CmdCallbackObject
+     */
+    virtual bool callStreamFunct(size_t idx, CmdParser *cmdParser,
+                                 uint16_t param, uint16_t count)
+    {
+        if (this->isStoreStream(idx)) {
+            m_streamFunctList[idx](cmdParser, param, count);
             return true;
         }
 
         return false;
     }
 
+#if defined(CMDCALLBACK_STATS)
+    /**
+     * @implement CmdCallbackObject
+     */
+    virtual const CmdCallbackStats *getStoreStats(size_t idx)
+    {
+        if (idx < STORESIZE) {
+            return &m_statsList[idx];
+        }
+
+        return NULL;
+    }
+
+    /**
+     * @implement CmdCallbackObject
+     */
+    virtual void clearStats()
+    {
+        CmdCallbackObject::clearStats();
+        memset(m_statsList, 0x00, sizeof(m_statsList));
+    }
+#endif
+
   protected:
+#if defined(CMDCALLBACK_STATS)
+    /**
+     * @implement CmdCallbackObject
+     */
+    virtual void printStoreCmd(size_t idx, Print *out)
+    {
+        out->print(m_cmdList[idx]);
+    }
+
+    /** Counters of each command */
+    CmdCallbackStats m_statsList[STORESIZE];
+#endif
+
     /** Array with list of commands */
     T m_cmdList[STORESIZE];
 
     /** List of function  */
     CmdCallFunct m_functList[STORESIZE];
 
+    /** List of stream functions @see addStreamCmd */
+    CmdStreamFunct m_streamFunctList[STORESIZE];
+
     /** Pointer tof next element in array @see addCmd */
     size_t m_nextElement;
+
+  private:
+    /**
+     * Call function of a command, a stream function with the params not
+     * streamed before the end of line.
+     */
+    void callFunct(size_t idx, CmdParser *cmdParser)
+    {
+        if (!this->isStoreStream(idx)) {
+            m_functList[idx](cmdParser);
+            return;
+        }
+
+        for (uint16_t i = 1; i <= cmdParser->getParamCount(); i++) {
+            this->callStreamFunct(idx, cmdParser, i, this->m_streamBase + i);
+        }
+        this->callStreamFunct(idx, cmdParser, 0,
+                              this->m_streamBase + cmdParser->getParamCount());
+    }
 };
 
 #if defined(__AVR__) || defined(ESP8266)
@@ -192,15 +527,27 @@ class CmdCallback_P : public _CmdCallback<STORESIZE, CmdParserString_P>
     /**
      * @implement CmdCallbackObject with strcasecmp_P
      */
-    virtual bool equalStoreCmd(size_t idx, char *cmdStr)
+    virtual bool equalStoreCmd(size_t idx, const char *cmdStr, size_t size)
     {
         if (this->checkStorePos(idx) &&
-            strcasecmp_P(cmdStr, this->m_cmdList[idx]) == 0) {
+            strncasecmp_P(cmdStr, this->m_cmdList[idx], size) == 0 &&
+            pgm_read_byte(this->m_cmdList[idx] + size) == 0x00) {
             return true;
         }
 
         return false;
     }
+
+#if defined(CMDCALLBACK_STATS)
+    /**
+     * @implement CmdCallbackObject from progmem
+     */
+    virtual void printStoreCmd(size_t idx, Print *out)
+    {
+        out->print(reinterpret_cast<const __FlashStringHelper *>(
+            this->m_cmdList[idx]));
+    }
+#endif
 };
 
 #endif
@@ -215,15 +562,522 @@ class CmdCallback : public _CmdCallback<STORESIZE, CmdParserString>
     /**
      * @implement CmdCallbackObject with strcasecmp
      */
-    virtual bool equalStoreCmd(size_t idx, char *cmdStr)
+    virtual bool equalStoreCmd(size_t idx, const char *cmdStr, size_t size)
+    {
+        if (this->checkStorePos(idx) &&
+            cmdCallbackEqual(this->m_cmdList[idx], cmdStr, size)) {
+            return true;
+        }
+
+        return false;
+    }
+};
+
+/**
+ * Calc size of the hash table for a store: the next power of two with
+ * room for twice the number of commands.
+ */
+constexpr size_t cmdCallbackHashSize(size_t storeSize, size_t size = 1)
+{
+    return (storeSize <= CMDCALLBACK_HASH_MIN)
+               ? 1
+               : (size >= storeSize * 2)
+                     ? size
+                     : cmdCallbackHashSize(storeSize, size * 2);
+}
+
+/**
+ * Callback store with a hash table for searching commands. Command
+ * strings are hashed once and resolved with open addressing. Stores up to
+ * CMDCALLBACK_HASH_MIN commands are searched linear.
+ */
+template <size_t STORESIZE>
+class CmdCallbackHash : public _CmdCallback<STORESIZE, CmdParserString>
+{
+  public:
+    /**
+     * Cleanup hash table
+     */
+    CmdCallbackHash()
+    {
+        memset(m_hashTable, 0x00, sizeof(m_hashTable));
+        memset(m_hashList, 0x00, sizeof(m_hashList));
+    }
+
+    /**
+     * Link a callback function to command.
+     * @see _CmdCallback::addCmd
+     */
+    bool addCmd(CmdParserString cmdStr, CmdCallFunct cbFunct)
+    {
+        size_t idx = this->m_nextElement;
+        size_t slot;
+
+        if (!_CmdCallback<STORESIZE, CmdParserString>::addCmd(cmdStr,
+                                                              cbFunct)) {
+            return false;
+        }
+
+        if (HASHSIZE > 1) {
+            m_hashList[idx] =
+                CmdCallbackObject::hashCmd(cmdStr, strlen(cmdStr));
+
+            // find a free slot, table is never full
+            slot = m_hashList[idx] & (HASHSIZE - 1);
+            while (m_hashTable[slot] != 0) {
+                slot = (slot + 1) & (HASHSIZE - 1);
+            }
+            m_hashTable[slot] = idx + 1;
+        }
+
+        return true;
+    }
+
+    using CmdCallbackObject::findStoreCmd;
+
+    /**
+     * @implement CmdCallbackObject with hash table
+     */
+    virtual size_t findStoreCmd(const char *cmdStr, size_t size)
+    {
+        uint16_t hash;
+        size_t   slot;
+        size_t   idx;
+
+        // small store
+        if (HASHSIZE <= 1) {
+            return CmdCallbackObject::findStoreCmd(cmdStr, size);
+        }
+
+        hash = CmdCallbackObject::hashCmd(cmdStr, size);
+
+        // search slots until a free one
+        for (slot = hash & (HASHSIZE - 1); m_hashTable[slot] != 0;
+             slot = (slot + 1) & (HASHSIZE - 1)) {
+            idx = m_hashTable[slot] - 1;
+
+            if (m_hashList[idx] == hash &&
+                cmdCallbackEqual(this->m_cmdList[idx], cmdStr, size)) {
+                return idx;
+            }
+        }
+
+        return CMDCALLBACK_NO_CMD;
+    }
+
+  private:
+    /** Size of hash table */
+    static const size_t HASHSIZE = cmdCallbackHashSize(STORESIZE);
+
+    /**
+     * @implement CmdCallbackObject with strcasecmp
+     */
+    virtual bool equalStoreCmd(size_t idx, const char *cmdStr, size_t size)
+    {
+        if (this->checkStorePos(idx) &&
+            cmdCallbackEqual(this->m_cmdList[idx], cmdStr, size)) {
+            return true;
+        }
+
+        return false;
+    }
+
+    /** Hash table with store number + 1 or 0 for a free slot */
+    uint16_t m_hashTable[HASHSIZE];
+
+    /** Hash of commands in store */
+    uint16_t m_hashList[STORESIZE];
+};
+
+// Result of CmdCallbackTrie::matchCmd
+#define CMDCALLBACK_MATCH_NONE      0   // no command starts with string
+#define CMDCALLBACK_MATCH_EXACT     1   // string is a command
+#define CMDCALLBACK_MATCH_PREFIX    2   // string starts only one command
+#define CMDCALLBACK_MATCH_AMBIGUOUS 3   // string starts many commands
+
+/**
+ * Node of a trie with a character of a command @see CmdCallbackTrie.
+ * Links and store numbers are +1, so 0 is none.
+ */
+struct CmdCallbackNode
+{
+    /** Lower case character */
+    uint8_t chr;
+
+    /** First child and next sibling node */
+    uint8_t child;
+    uint8_t next;
+
+    /** Store number of command ending here */
+    uint8_t exact;
+
+    /** Store number of the only command below or 0xFF for many */
+    uint8_t unique;
+};
+
+/**
+ * Calc default number of trie nodes for a store.
+ */
+constexpr size_t cmdCallbackTrieSize(size_t storeSize)
+{
+    return (storeSize * 6 < 254) ? storeSize * 6 : 254;
+}
+
+/**
+ * Callback store with a case insensitive trie for searching commands in
+ * time of the command length. With setOptPrefix a unique abbreviation of
+ * a command is found too, i.e. "st" for "status" if no "start" is in
+ * store. Each node use 5 bytes, up to 254 nodes.
+ *
+ * @note The nodes are build in SRAM by addCmd. They link by array
+ * index without pointers, but are not read from PROGMEM. For a constant
+ * command list in flash use CmdCallback_P.
+ */
+template <size_t STORESIZE, size_t NODESIZE = cmdCallbackTrieSize(STORESIZE)>
+class CmdCallbackTrie : public _CmdCallback<STORESIZE, CmdParserString>
+{
+    static_assert(STORESIZE < 0xFF && NODESIZE < 0xFF,
+                  "CmdCallbackTrie supports up to 254 commands and nodes");
+
+  public:
+    /**
+     * Cleanup trie
+     */
+    CmdCallbackTrie() : m_root(0), m_nodeCount(0), m_usePrefix(false)
+    {
+        memset(m_nodeList, 0x00, sizeof(m_nodeList));
+    }
+
+    /**
+     * Link a callback function to command.
+     * @see _CmdCallback::addCmd
+     *
+     * @return                  FALSE if store or trie is full
+     */
+    bool addCmd(CmdParserString cmdStr, CmdCallFunct cbFunct)
+    {
+        uint8_t  idx = this->m_nextElement + 1;
+        uint8_t *link;
+        uint8_t  node;
+        size_t   pos;
+
+        if (cmdStr == NULL || cmdStr[0] == 0x00) {
+            return false;
+        }
+
+        // nodes for the rest of command must be free
+        link = &m_root;
+        for (pos = 0; cmdStr[pos] != 0x00; pos++) {
+            node = this->findNode(*link, cmdStr[pos]);
+            if (node == 0) {
+                break;
+            }
+            link = &m_nodeList[node - 1].child;
+        }
+        if (m_nodeCount + strlen(&cmdStr[pos]) > NODESIZE) {
+            return false;
+        }
+
+        if (!_CmdCallback<STORESIZE, CmdParserString>::addCmd(cmdStr,
+                                                              cbFunct)) {
+            return false;
+        }
+
+        // add path of command
+        link = &m_root;
+        for (pos = 0; cmdStr[pos] != 0x00; pos++) {
+            node = this->findNode(*link, cmdStr[pos]);
+
+            // new node in front of siblings
+            if (node == 0) {
+                node = ++m_nodeCount;
+                m_nodeList[node - 1].chr  = tolower(static_cast<uint8_t>(cmdStr[pos]));
+                m_nodeList[node - 1].next = *link;
+                *link                     = node;
+            }
+
+            if (m_nodeList[node - 1].unique == 0) {
+                m_nodeList[node - 1].unique = idx;
+            } else {
+                m_nodeList[node - 1].unique = 0xFF;
+            }
+            link = &m_nodeList[node - 1].child;
+        }
+
+        // first command wins like a linear search
+        if (m_nodeList[node - 1].exact == 0) {
+            m_nodeList[node - 1].exact = idx;
+        }
+
+        return true;
+    }
+
+    /**
+     * Search a command or a abbreviation of a command.
+     *
+     * @param cmdStr            Cmd string to search
+     * @param idx               Optional, return store number for
+     *                          CMDCALLBACK_MATCH_EXACT and _PREFIX
+     * @return                  CMDCALLBACK_MATCH_NONE, _EXACT, _PREFIX or
+     *                          _AMBIGUOUS
+     */
+    uint8_t matchCmd(const char *cmdStr, size_t *idx = NULL)
+    {
+        if (cmdStr == NULL) {
+            return CMDCALLBACK_MATCH_NONE;
+        }
+
+        return this->matchView(cmdStr, strlen(cmdStr), idx);
+    }
+
+    using CmdCallbackObject::findStoreCmd;
+
+    /**
+     * @implement CmdCallbackObject with trie, finds a unique abbreviation
+     * if setOptPrefix is set
+     */
+    virtual size_t findStoreCmd(const char *cmdStr, size_t size)
+    {
+        size_t  idx;
+        uint8_t match = this->matchView(cmdStr, size, &idx);
+
+        if (match == CMDCALLBACK_MATCH_EXACT ||
+            (match == CMDCALLBACK_MATCH_PREFIX && m_usePrefix)) {
+            return idx;
+        }
+
+        return CMDCALLBACK_NO_CMD;
+    }
+
+    /**
+     * Set option to process a command by a unique abbreviation.
+     * Default is off
+     *
+     * @param onOff             Set option TRUE (on) or FALSE (off)
+     */
+    void setOptPrefix(bool onOff = true) { m_usePrefix = onOff; }
+
+    /**
+     * Get number of used trie nodes.
+     *
+     * @return                  Number of nodes
+     */
+    size_t getNodeCount() { return m_nodeCount; }
+
+  private:
+    /**
+     * Search a command or a abbreviation with size @see matchCmd.
+     */
+    uint8_t matchView(const char *cmdStr, size_t size, size_t *idx)
+    {
+        uint8_t node = 0;
+        uint8_t link = m_root;
+
+        if (cmdStr == NULL || size == 0) {
+            return CMDCALLBACK_MATCH_NONE;
+        }
+
+        for (size_t pos = 0; pos < size; pos++) {
+            node = this->findNode(link, cmdStr[pos]);
+            if (node == 0) {
+                return CMDCALLBACK_MATCH_NONE;
+            }
+            link = m_nodeList[node - 1].child;
+        }
+
+        if (m_nodeList[node - 1].exact != 0) {
+            if (idx != NULL) {
+                *idx = m_nodeList[node - 1].exact - 1;
+            }
+            return CMDCALLBACK_MATCH_EXACT;
+        }
+        if (m_nodeList[node - 1].unique != 0xFF) {
+            if (idx != NULL) {
+                *idx = m_nodeList[node - 1].unique - 1;
+            }
+            return CMDCALLBACK_MATCH_PREFIX;
+        }
+
+        return CMDCALLBACK_MATCH_AMBIGUOUS;
+    }
+
+    /**
+     * @implement CmdCallbackObject with strcasecmp
+     */
+    virtual bool equalStoreCmd(size_t idx, const char *cmdStr, size_t size)
     {
         if (this->checkStorePos(idx) &&
-            strcasecmp(this->m_cmdList[idx], cmdStr) == 0) {
+            cmdCallbackEqual(this->m_cmdList[idx], cmdStr, size)) {
             return true;
         }
 
         return false;
     }
+
+    /**
+     * Search a character in a list of siblings.
+     *
+     * @param link              First node of siblings
+     * @param chr               Character to search
+     * @return                  Node or 0 if not found
+     */
+    uint8_t findNode(uint8_t link, char chr)
+    {
+        uint8_t lower = tolower(static_cast<uint8_t>(chr));
+
+        while (link != 0 && m_nodeList[link - 1].chr != lower) {
+            link = m_nodeList[link - 1].next;
+        }
+        return link;
+    }
+
+    /** First node of commands */
+    uint8_t m_root;
+
+    /** Nodes of the trie */
+    CmdCallbackNode m_nodeList[NODESIZE];
+    uint8_t         m_nodeCount;
+
+    /** Option @see setOptPrefix */
+    bool m_usePrefix;
+};
+
+/**
+ * Entry of a command table @see CmdCallbackTable
+ */
+struct CmdCallbackEntry
+{
+    /** Command string */
+    CmdParserString cmdStr;
+
+    /** Callback function to process the command */
+    CmdCallFunct cbFunct;
+};
+
+/**
+ * Lower case of a ASCII character, usable at compile time.
+ */
+constexpr uint8_t cmdCallbackLower(uint8_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/**
+ * Compare two strings case insensitive like strcasecmp, usable at compile
+ * time.
+ */
+constexpr int cmdCallbackCompare(const char *a, const char *b)
+{
+    return (cmdCallbackLower(*a) != cmdCallbackLower(*b) || *a == 0x00)
+               ? cmdCallbackLower(*a) - cmdCallbackLower(*b)
+               : cmdCallbackCompare(a + 1, b + 1);
+}
+
+/**
+ * Check at compile time if a command table is sorted and every command
+ * is unique.
+ *
+ * static_assert(cmdCallbackSorted(myTable), "table not sorted");
+ */
+template <size_t N>
+constexpr bool cmdCallbackSorted(const CmdCallbackEntry (&table)[N],
+                                 size_t idx = 1)
+{
+    return (idx >= N) ? true
+                      : cmdCallbackCompare(table[idx - 1].cmdStr,
+                                           table[idx].cmdStr) < 0 &&
+                            cmdCallbackSorted(table, idx + 1);
+}
+
+/**
+ * Callback store from a constant table of commands, sorted case
+ * insensitive by command string. The table is build by the compiler and
+ * need no addCmd calls at startup. Commands are searched binary and
+ * called without virtual functions.
+ *
+ * constexpr CmdCallbackEntry myTable[] = {{"get", funcGet},
+ *                                         {"set", funcSet}};
+ * static_assert(cmdCallbackSorted(myTable), "table not sorted");
+ * CmdCallbackTable myCallback(myTable);
+ *
+ * @note On AVR the constant table is copied to SRAM.
+ */
+class CmdCallbackTable
+{
+  public:
+    /**
+     * Set a sorted table of commands.
+     *
+     * @param table             Array with commands
+     * @param size              Number of commands in array
+     */
+    constexpr CmdCallbackTable(const CmdCallbackEntry *table, size_t size)
+        : m_table(table), m_size(size)
+    {
+    }
+
+    template <size_t N>
+    constexpr CmdCallbackTable(const CmdCallbackEntry (&table)[N])
+        : m_table(table), m_size(N)
+    {
+    }
+
+    /**
+     * @see CmdCallbackObject::loopCmdProcessing
+     */
+    void loopCmdProcessing(CmdParser *cmdParser, CmdBufferObject *cmdBuffer,
+                           Stream *serial) const;
+
+    /**
+     * @see CmdCallbackObject::updateCmdProcessing
+     */
+    void updateCmdProcessing(CmdParser *cmdParser, CmdBufferObject *cmdBuffer,
+                             Stream *serial) const;
+
+    /**
+     * @see CmdCallbackObject::processCmd
+     */
+    bool processCmd(CmdParser *cmdParser) const;
+
+    /**
+     * @see CmdCallbackObject::processCmds
+     */
+    size_t processCmds(CmdParser *cmdParser) const;
+
+    /**
+     * @see CmdCallbackObject::hasCmd
+     */
+    bool hasCmd(char *cmdStr) const
+    {
+        return this->findStoreCmd(cmdStr) != CMDCALLBACK_NO_CMD;
+    }
+
+    /**
+     * @see CmdCallbackObject::findStoreCmd
+     */
+    size_t findStoreCmd(const char *cmdStr) const
+    {
+        return this->findStoreCmd(cmdStr, strlen(cmdStr));
+    }
+
+    /**
+     * @see CmdCallbackObject::findStoreCmd
+     */
+    size_t findStoreCmd(const char *cmdStr, size_t size) const;
+
+    /**
+     * Give the number of commands in table.
+     *
+     * @return                  Size of table
+     */
+    size_t getStoreSize() const { return m_size; }
+
+  private:
+    /** Sorted array with commands */
+    const CmdCallbackEntry *m_table;
+
+    /** Number of commands in array */
+    size_t m_size;
 };
 
 #endif
@@ -0,0 +1,84 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include "CmdFrame.h"
+
+CmdFrame::CmdFrame(Print *out) : m_out(out), m_crc(CMDBUFFER_CRC_INIT)
+{
+}
+
+void CmdFrame::beginFrame(const char *cmdStr)
+{
+    m_crc = CMDBUFFER_CRC_INIT;
+
+    // end noise on the line before
+    m_out->write(CMDBUFFER_SLIP_END);
+    this->writeData(cmdStr, strlen(cmdStr) + 1);
+}
+
+void CmdFrame::addInt(int32_t value)
+{
+    this->writeByte(CMDPARSER_TYPE_INT);
+    this->writeUint32(static_cast<uint32_t>(value));
+}
+
+void CmdFrame::addFloat(float value)
+{
+    uint32_t bits;
+
+    // float has the byte order of integers on all targets
+    memcpy(&bits, &value, sizeof(bits));
+    this->writeByte(CMDPARSER_TYPE_FLOAT);
+    this->writeUint32(bits);
+}
+
+void CmdFrame::addString(const char *value)
+{
+    this->writeByte(CMDPARSER_TYPE_STRING);
+    this->writeData(value, strlen(value) + 1);
+}
+
+void CmdFrame::endFrame()
+{
+    uint16_t crc = m_crc;
+
+    // high byte first, so CRC over payload and CRC is 0
+    this->writeByte(crc >> 8);
+    this->writeByte(crc & 0xFF);
+    m_out->write(CMDBUFFER_SLIP_END);
+}
+
+void CmdFrame::writeByte(uint8_t data)
+{
+    m_crc = CmdBufferObject::crc16(m_crc, data);
+
+    if (data == CMDBUFFER_SLIP_END) {
+        m_out->write(CMDBUFFER_SLIP_ESC);
+        m_out->write(CMDBUFFER_SLIP_ESC_END);
+    } else if (data == CMDBUFFER_SLIP_ESC) {
+        m_out->write(CMDBUFFER_SLIP_ESC);
+        m_out->write(CMDBUFFER_SLIP_ESC_ESC);
+    } else {
+        m_out->write(data);
+    }
+}
+
+void CmdFrame::writeData(const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+    for (size_t i = 0; i < size; i++) {
+        this->writeByte(bytes[i]);
+    }
+}
+
+void CmdFrame::writeUint32(uint32_t data)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        this->writeByte(data & 0xFF);
+        data >>= 8;
+    }
+}
@@ -0,0 +1,89 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#ifndef _CMDFRAME_H_
+#define _CMDFRAME_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#include "CmdBuffer.h"
+#include "CmdParser.h"
+
+/**
+ * Write a binary command as SLIP frame with CRC-16, read by a buffer with
+ * CmdBufferObject::setOptBinary and parsed by CmdParser::parseBinary.
+ *
+ * CmdFrame frame(&Serial);
+ * frame.beginFrame("speed");
+ * frame.addInt(1200);
+ * frame.addFloat(0.5);
+ * frame.endFrame();
+ */
+class CmdFrame
+{
+  public:
+    /**
+     * Set output of frames.
+     *
+     * @param out           Output, i.e. Serial
+     */
+    CmdFrame(Print *out);
+
+    /**
+     * Start a frame with the command word.
+     *
+     * @param cmdStr        Command word
+     */
+    void beginFrame(const char *cmdStr);
+
+    /**
+     * Add a param of type CMDPARSER_TYPE_INT, _FLOAT or _STRING.
+     *
+     * @param value         Value of param
+     */
+    void addInt(int32_t value);
+    void addFloat(float value);
+    void addString(const char *value);
+
+    /**
+     * Write CRC and end the frame.
+     */
+    void endFrame();
+
+  private:
+    /**
+     * Write a byte SLIP encoded and add it to CRC.
+     *
+     * @param data          Byte of payload
+     */
+    void writeByte(uint8_t data);
+
+    /**
+     * Write data SLIP encoded and add it to CRC.
+     *
+     * @param data          Payload
+     * @param size          Size of payload
+     */
+    void writeData(const void *data, size_t size);
+
+    /**
+     * Write 4 bytes SLIP encoded, little endian.
+     *
+     * @param data          Value
+     */
+    void writeUint32(uint32_t data);
+
+    /** Output of frames */
+    Print *m_out;
+
+    /** CRC of current frame */
+    uint16_t m_crc;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include "CmdMux.h"
+
+CmdMuxObject::CmdMuxObject(CmdMuxChannel *channels, size_t size)
+    : m_channels(channels),
+      m_size(size),
+      m_count(0),
+      m_next(0),
+      m_budget(CMDMUX_BYTE_BUDGET)
+{
+}
+
+bool CmdMuxObject::addChannel(CmdParser *      cmdParser,
+                              CmdBufferObject *cmdBuffer,
+                              Stream *         serial)
+{
+    // Store is full
+    if (m_count >= m_size) {
+        return false;
+    }
+
+    m_channels[m_count].cmdParser = cmdParser;
+    m_channels[m_count].cmdBuffer = cmdBuffer;
+    m_channels[m_count].serial    = serial;
+
+    ++m_count;
+    return true;
+}
+
+size_t CmdMuxObject::updateCmdProcessing(CmdCallbackObject *callback)
+{
+    size_t processed = 0;
+    size_t idx       = m_next;
+
+    for (size_t i = 0; i < m_count; i++) {
+        CmdMuxChannel *channel = &m_channels[idx];
+
+        // read up to budget from channel
+        for (size_t bytes = 0;
+             bytes < m_budget && channel->serial->available(); bytes++) {
+
+            // read data and check if command was entered
+            if (channel->cmdBuffer->readSerialChar(channel->serial)) {
+                // parse command line
+                if (channel->cmdParser->parseCmd(channel->cmdBuffer) !=
+                    CMDPARSER_ERROR) {
+                    // search commands in store and call functions
+                    // commands not found are ignored
+                    processed += callback->processCmds(channel->cmdParser,
+                                                       channel->serial,
+                                                       channel->cmdBuffer);
+                }
+
+                // remove also empty or broken lines from buffer
+                channel->cmdBuffer->clear();
+            }
+        }
+
+        if (++idx >= m_count) {
+            idx = 0;
+        }
+    }
+
+    // next round starts with next channel
+    if (m_count > 0 && ++m_next >= m_count) {
+        m_next = 0;
+    }
+
+    return processed;
+}
+
+void CmdMuxObject::loopCmdProcessing(CmdCallbackObject *callback)
+{
+    do {
+        this->updateCmdProcessing(callback);
+    } while (true);
+}
@@ -0,0 +1,133 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#ifndef _CMDMUX_H_
+#define _CMDMUX_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#include "CmdBuffer.h"
+#include "CmdCallback.h"
+#include "CmdParser.h"
+
+// Default number of bytes read from a channel in one round
+#ifndef CMDMUX_BYTE_BUDGET
+#define CMDMUX_BYTE_BUDGET      16
+#endif
+
+/**
+ * A serial port with own parser and buffer @see CmdMuxObject
+ */
+struct CmdMuxChannel
+{
+    /** Parser object with options set */
+    CmdParser *cmdParser;
+
+    /** Buffer object for data handling */
+    CmdBufferObject *cmdBuffer;
+
+    /** Arduino serial interface from comming data */
+    Stream *serial;
+};
+
+/**
+ * Process commands from many serial ports with one callback store.
+ * Channels are polled round robin and read at most a budget of bytes
+ * each round, so a busy port can not starve the others.
+ */
+class CmdMuxObject
+{
+  public:
+    /**
+     * Set storage of channels.
+     *
+     * @param channels          Storage for channels
+     * @param size              Number of channels in storage
+     */
+    CmdMuxObject(CmdMuxChannel *channels, size_t size);
+
+    /**
+     * Add a serial port.
+     *
+     * @param cmdParser         Parser object with options set
+     * @param cmdBuffer         Buffer object for data handling
+     * @param serial            Arduino serial interface from comming data
+     * @return                  TRUE if you have space in channel store
+     */
+    bool addChannel(CmdParser *cmdParser, CmdBufferObject *cmdBuffer,
+                    Stream *serial);
+
+    /**
+     * Set how many bytes are read from a channel in one round.
+     * Default is CMDMUX_BYTE_BUDGET.
+     *
+     * @param budget            Number of bytes, at least 1
+     */
+    void setByteBudget(size_t budget) { m_budget = budget > 0 ? budget : 1; }
+
+    /**
+     * Read one round from all channels and execute the callback function
+     * of every complete command.
+     *
+     * @param callback          Callback store for commands
+     * @return                  Number of commands found in the store,
+     *                          each command of a batch line counts
+     */
+    size_t updateCmdProcessing(CmdCallbackObject *callback);
+
+    /**
+     * Endless loop for process incoming data from all channels.
+     *
+     * @param callback          Callback store for commands
+     */
+    void loopCmdProcessing(CmdCallbackObject *callback);
+
+    /**
+     * Get number of channels.
+     *
+     * @return                  Number of added channels
+     */
+    size_t getChannelCount() { return m_count; }
+
+  private:
+    /** Storage of channels */
+    CmdMuxChannel *m_channels;
+
+    /** Size of channel storage */
+    size_t m_size;
+
+    /** Number of added channels */
+    size_t m_count;
+
+    /** First channel of next round */
+    size_t m_next;
+
+    /** Bytes read from a channel in one round */
+    size_t m_budget;
+};
+
+/**
+ *
+ *
+ */
+template <size_t CHANNELS>
+class CmdMux : public CmdMuxObject
+{
+  public:
+    /**
+     * Set storage of channels
+     */
+    CmdMux() : CmdMuxObject(m_store, CHANNELS) {}
+
+  private:
+    /** Storage of channels */
+    CmdMuxChannel m_store[CHANNELS];
+};
+
+#endif
@@ -7,17 +7,47 @@
 
 #include "CmdParser.h"
 
+#include <float.h>
+#include <stdlib.h>
+
+#if !defined(CMDPARSER_NO_SIMD)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CMDPARSER_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CMDPARSER_SIMD_NEON
+#endif
+#endif
+
 CmdParser::CmdParser()
     : m_ignoreQuote(false),
       m_useKeyValue(false),
+      m_keepBuffer(false),
       m_seperator(CMDPARSER_CHAR_SP),
+      m_cmdDelimiter(0x00),
       m_checkParens(false),
       m_open_paren(  '(' ),
       m_close_paren( ')' ),
+      m_optFixed(false),
     //  m_ID(CMDPARSER_NO_ID),
       m_buffer(NULL),
       m_bufferSize(0),
       m_paramCount(0),
+      m_wordCount(0),
+      m_cmdCount(0),
+      m_tokenBase(0),
+      m_tokenEnd(0),
+      m_scanBegin(0),
+      m_scanEnd(0),
+      m_tokenCount(0),
+      m_keyTotal(0),
+      m_keyBase(0),
+      m_keyCount(0),
+      m_keyIndex(false),
+      m_binary(false),
+      m_incValid(false),
+      m_incDone(false),
       m_errorStr(NULL),
       m_warningStr(NULL)
 {
@@ -25,9 +55,29 @@ CmdParser::CmdParser()
 
 uint16_t CmdParser::parseCmd(uint8_t *buffer, size_t bufferSize)
 {
-    bool isString = false;
-    bool isInsideParen  = false;
+    return this->parseBuffer<CmdParserRuntime>(buffer, bufferSize);
+}
+
+
+// Init all parser state for a new buffer
+// @return  false if buffer is not okay
+bool CmdParser::beginParse(uint8_t *buffer, size_t bufferSize)
+{
     m_paramCount = 0;   // init param count
+    m_wordCount  = 0;
+    m_cmdCount   = 0;   // init command records
+    m_tokenBase  = 0;
+    m_tokenEnd   = 0;
+    m_scanBegin  = 0;
+    m_scanEnd    = 0;
+    m_tokenCount = 0;   // init token index
+    m_keyTotal   = 0;   // init key index
+    m_keyBase    = 0;
+    m_keyCount   = 0;
+    m_keyIndex   = false;
+    m_binary     = false;
+    m_incValid   = false;
+    m_incDone    = false;
     m_errorStr   = NULL;   // clear errors at start of parsing
     m_warningStr = NULL;
 
@@ -35,71 +85,35 @@ uint16_t CmdParser::parseCmd(uint8_t *buffer, size_t bufferSize)
     if (buffer == NULL || bufferSize == 0 || buffer[0] == 0x00) {
         //if(m_errorStr == NULL)
         //    m_errorStr = (char *)"Error: parse buffer is NULL or empty";
-        return CMDPARSER_ERROR;
+        return false;
     }
 
     // init buffer
     m_buffer     = buffer;
     m_bufferSize = bufferSize;
 
-    ////
-    // Run Parser
-    for (size_t i = 0; i < bufferSize; i++) {
+    // first command starts at beginning of buffer
+    m_cmdRecord[0].token  = 0;
+    m_cmdRecord[0].key    = 0;
+    m_cmdRecord[0].offset = 0;
+    m_cmdCount            = 1;
 
-        // this should never happen
-        if (buffer[i] == 0x00 || m_paramCount == 0xFFFE) {
-            if (i > 0 && buffer[i-1] != 0x00) {
-                m_paramCount++;
-            }
-            if( isString == true ) {
-                if(m_errorStr == NULL)
-                    m_errorStr = (char *)"Error: something strange happened";
-            }
-            return m_paramCount;
-        }
-        // remove quotes, but do not remove seperator inside quotes
-        // example string: "Hello world!"
-        else if (!m_ignoreQuote && buffer[i] == CMDPARSER_CHAR_DQ) {
-            buffer[i] = 0x00;
-            isString  = !isString;
-        }
-        // replace seperator with '\0'
-        else if (!isString && !isInsideParen && buffer[i] == m_seperator) {
-            buffer[i] = 0x00;
-        }
-        // check for parentheses
-        else if (m_checkParens && buffer[i] == m_open_paren) {
-            if( isInsideParen ==  true ) {
-                if(m_warningStr == NULL)
-                    m_warningStr = (char *)"Warning: expected closing parentheses";
-            }
-            else
-                isInsideParen = true;
-            buffer[i] = 0x00;
-        }
-        else if (m_checkParens && buffer[i] == m_close_paren) {
-            if( isInsideParen ==  false ) {
-                if(m_warningStr == NULL)
-                    m_warningStr = (char *)"Warning: expected opening parentheses";
-            }
-            else
-                isInsideParen = false;
-            buffer[i] = 0x00;
-        }
-        // replace = with '\0' if KEY=Value is set
-        //else if (!isString && m_useKeyValue && buffer[i] == CMDPARSER_CHAR_EQ) {
-        //    buffer[i] = 0x00;
-        //}
-
-        // count
-        if (i > 0 && buffer[i] != 0x00 && buffer[i-1] == 0x00) {
-            m_paramCount++;  // found start of word
-        }
-        if (i == 0 && buffer[i] != 0x00) {
-            m_paramCount++;  // found word at beginning of buffer
-            // Note: need to count the command word here to prevent a misscount
-            // if there is a leading seperator at the beginning of the buffer
-        }
+    return true;
+}
+
+
+// Check the parser state at the end of data and build the indexes
+// @param  size   size of parsed data
+// @return  number of params of the first command
+uint16_t CmdParser::endParse(size_t size, bool isString, bool isInsideParen,
+                             bool keyValue)
+{
+    // lookups must not run past the end of data
+    m_bufferSize = size;
+
+    // skip a empty command behind the last delimiter
+    if (m_cmdCount > 1 && m_cmdRecord[m_cmdCount - 1].token == m_wordCount) {
+        m_cmdCount--;
     }
 
     // check for missing quotes
@@ -113,9 +127,363 @@ uint16_t CmdParser::parseCmd(uint8_t *buffer, size_t bufferSize)
             m_warningStr = (char *)"Warning: Missmatched parentheses";
     }
 
+    // index KEY=Value params
+    if (keyValue) {
+        this->indexKeys();
+    }
+
+    this->selectRecord(0);
+    return m_paramCount;
+}
+
+
+// Start parsing a line while receiving
+// @param  buffer   line buffer with first character stored
+void CmdParser::beginIncremental(uint8_t *buffer)
+{
+    m_state.isString      = false;
+    m_state.isInsideParen = false;
+    m_state.isToken       = false;
+    m_state.keepBuffer    = true;   // terminated by takeIncremental
+
+    m_incValid = this->beginParse(buffer, 1);
+}
+
+
+// Parse the stored character at offset
+void CmdParser::parseIncremental(size_t offset)
+{
+    if (m_incValid &&
+        !this->parseStep(m_buffer, offset, &m_state)) {
+        m_incValid = false;
+    }
+}
+
+
+bool CmdParser::parseStep(uint8_t *buffer, size_t i, CmdParserState *state)
+{
+    return this->parseChar<CmdParserRuntime>(buffer, i, state);
+}
+
+
+// Line was edited, so parseCmd makes a full parse
+void CmdParser::abortIncremental()
+{
+    m_incValid = false;
+    m_incDone  = false;
+}
+
+
+// End of line is received
+// @param  size   size of line
+void CmdParser::endIncremental(size_t size)
+{
+    if (!m_incValid || size == 0) {
+        this->abortIncremental();
+        return;
+    }
+
+    // last word runs up to the end of data
+    if (m_state.isToken) {
+        this->endToken(size);
+    }
+
+    this->endParse(size, m_state.isString, m_state.isInsideParen,
+                   m_useKeyValue);
+    m_incValid = false;
+    m_incDone  = true;
+}
+
+
+// Cmd word of line in receiving
+// @return  view with NULL if word is not complete
+CmdParserView CmdParser::getIncrementalCommand()
+{
+    CmdParserView view = {NULL, 0};
+
+    if (m_incValid && m_cmdCount == 1 && m_wordCount > 0 &&
+        (m_wordCount > 1 || !m_state.isToken)) {
+        view.str  = reinterpret_cast<char *>(&m_buffer[m_tokenOffset[0]]);
+        view.size = m_tokenLength[0];
+    }
+
+    return view;
+}
+
+
+// Words of line in receiving
+// @return  0 if line can't be cut behind the last word
+uint16_t CmdParser::getIncrementalWords()
+{
+    if (!m_incValid || m_cmdCount != 1 || m_state.isToken ||
+        m_state.isString || m_state.isInsideParen) {
+        return 0;
+    }
+
+    return m_wordCount;
+}
+
+
+// Use result of parsing while receiving for this line
+// @return  true if line is parsed
+bool CmdParser::takeIncremental(uint8_t *buffer, size_t bufferSize)
+{
+    size_t end = 0;
+
+    if (!m_incDone || buffer != m_buffer || bufferSize != m_bufferSize) {
+        return false;
+    }
+    m_incDone = false;
+
+    if (m_keepBuffer) {
+        return true;
+    }
+
+    // searching in buffer needs all seperators replaced
+    if (m_tokenCount < m_wordCount || (m_useKeyValue && !m_keyIndex)) {
+        return false;
+    }
+
+    // all chars between the words are seperators, quotes or parentheses
+    for (uint16_t i = 0; i < m_tokenCount; i++) {
+        memset(&buffer[end], 0x00, m_tokenOffset[i] - end);
+        end = m_tokenOffset[i] + m_tokenLength[i];
+    }
+    memset(&buffer[end], 0x00, bufferSize - end);
+    return true;
+}
+
+
+// Parse a binary payload into the token index
+// @return  number of params or CMDPARSER_ERROR
+uint16_t CmdParser::parseBinary(uint8_t *buffer, size_t bufferSize)
+{
+    uint8_t *end;
+    size_t   i;
+
+    if (!this->beginParse(buffer, bufferSize)) {
+        return CMDPARSER_ERROR;
+    }
+    m_binary = true;
+
+    // command word
+    end = static_cast<uint8_t *>(memchr(buffer, 0x00, bufferSize));
+    if (end == NULL) {
+        i = bufferSize + 1;
+    } else {
+        this->beginToken(0);
+        this->endToken(end - buffer);
+        i = end - buffer + 1;
+    }
+
+    // params with type
+    while (i < bufferSize) {
+        switch (buffer[i++]) {
+        case CMDPARSER_TYPE_INT:
+        case CMDPARSER_TYPE_FLOAT:
+            if (i + 4 > bufferSize) {
+                i = bufferSize + 1;
+                break;
+            }
+            this->beginToken(i);
+            this->endToken(i + 4);
+            i += 4;
+            break;
+        case CMDPARSER_TYPE_STRING:
+            end = static_cast<uint8_t *>(memchr(&buffer[i], 0x00, bufferSize - i));
+            if (end == NULL) {
+                i = bufferSize + 1;
+                break;
+            }
+            this->beginToken(i);
+            this->endToken(end - buffer);
+            i = end - buffer + 1;
+            break;
+        default:
+            i = bufferSize + 1;
+            break;
+        }
+
+        // params can't be searched in the buffer
+        if (m_wordCount > CMDPARSER_MAX_TOKENS) {
+            i = bufferSize + 1;
+        }
+    }
+
+    // payload is broken
+    if (i > bufferSize) {
+        m_wordCount  = 0;
+        m_tokenCount = 0;
+        m_cmdCount   = 0;
+        if(m_errorStr == NULL)
+            m_errorStr = (char *)"Error: invalid binary payload";
+        return CMDPARSER_ERROR;
+    }
+
+    return this->endParse(bufferSize, false, false, false);
+}
+
+
+// Select a command of the batch
+// @param  command number starting from 0
+// @return  number of params of the command or CMDPARSER_ERROR
+uint16_t CmdParser::selectCmd(uint16_t idx)
+{
+    if (idx >= m_cmdCount) {
+        return CMDPARSER_ERROR;
+    }
+
+    this->selectRecord(idx);
+    return m_paramCount;
+}
+
+
+// Start a new command record behind a delimiter
+// @param  offset   first byte behind the delimiter
+void CmdParser::beginCmd(size_t offset)
+{
+    CmdParserRecord *record = &m_cmdRecord[m_cmdCount - 1];
+
+    // reuse a empty command, i.e. ";;"
+    if (record->token == m_wordCount) {
+        record->offset = offset;
+        return;
+    }
+
+    // records are full, add to last command
+    if (m_cmdCount >= CMDPARSER_MAX_CMDS) {
+        if(m_warningStr == NULL)
+            m_warningStr = (char *)"Warning: too many commands";
+        return;
+    }
+
+    record++;
+    record->token  = m_wordCount;
+    record->key    = 0;
+    record->offset = offset;
+    m_cmdCount++;
+}
+
+
+// Set words, buffer range and key pairs of a command
+// @param  command number starting from 0
+void CmdParser::selectRecord(uint16_t idx)
+{
+    bool     isLast   = (idx + 1u >= m_cmdCount);
+    uint16_t tokenEnd = isLast ? m_wordCount : m_cmdRecord[idx + 1].token;
+
+    m_tokenBase = m_cmdRecord[idx].token;
+    m_tokenEnd  = (tokenEnd < m_tokenCount) ? tokenEnd : m_tokenCount;
+    m_scanBegin = m_cmdRecord[idx].offset;
+    m_scanEnd   = isLast ? m_bufferSize : m_cmdRecord[idx + 1].offset;
+
+    m_paramCount = tokenEnd - m_tokenBase;
     if( m_paramCount > 0 )
       m_paramCount--;  // do not count command word
-    return m_paramCount;
+
+    m_keyBase  = 0;
+    m_keyCount = 0;
+    if (m_keyIndex) {
+        m_keyBase  = m_cmdRecord[idx].key;
+        m_keyCount = (isLast ? m_keyTotal : m_cmdRecord[idx + 1].key) - m_keyBase;
+    }
+}
+
+
+// Search the next character the parser must handle: '\0' and the given
+// seperator, quote, parentheses and delimiter characters. Use 0x00 for
+// unused ones.
+// With SSE2 or NEON 16 characters are checked at once.
+// @return  position of character or size if not found
+size_t CmdParser::findSpecialChar(const uint8_t *buffer, size_t offset,
+                                  size_t size, uint8_t seperator,
+                                  uint8_t quote, uint8_t open, uint8_t close,
+                                  uint8_t delimiter)
+{
+#if defined(CMDPARSER_SIMD_SSE2)
+    const __m128i vZero  = _mm_setzero_si128();
+    const __m128i vSep   = _mm_set1_epi8(static_cast<char>(seperator));
+    const __m128i vQuote = _mm_set1_epi8(static_cast<char>(quote));
+    const __m128i vOpen  = _mm_set1_epi8(static_cast<char>(open));
+    const __m128i vClose = _mm_set1_epi8(static_cast<char>(close));
+    const __m128i vDelim = _mm_set1_epi8(static_cast<char>(delimiter));
+
+    for (; offset + 16 <= size; offset += 16) {
+        __m128i data =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(&buffer[offset]));
+        __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(data, vZero),
+                         _mm_or_si128(_mm_cmpeq_epi8(data, vSep),
+                                      _mm_cmpeq_epi8(data, vDelim))),
+            _mm_or_si128(_mm_cmpeq_epi8(data, vQuote),
+                         _mm_or_si128(_mm_cmpeq_epi8(data, vOpen),
+                                      _mm_cmpeq_epi8(data, vClose))));
+        int mask = _mm_movemask_epi8(found);
+
+        if (mask != 0) {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#elif defined(CMDPARSER_SIMD_NEON)
+    const uint8x16_t vSep   = vdupq_n_u8(seperator);
+    const uint8x16_t vQuote = vdupq_n_u8(quote);
+    const uint8x16_t vOpen  = vdupq_n_u8(open);
+    const uint8x16_t vClose = vdupq_n_u8(close);
+    const uint8x16_t vDelim = vdupq_n_u8(delimiter);
+
+    for (; offset + 16 <= size; offset += 16) {
+        uint8x16_t data  = vld1q_u8(&buffer[offset]);
+        uint8x16_t found = vorrq_u8(
+            vorrq_u8(vceqq_u8(data, vdupq_n_u8(0)),
+                     vorrq_u8(vceqq_u8(data, vSep), vceqq_u8(data, vDelim))),
+            vorrq_u8(vceqq_u8(data, vQuote),
+                     vorrq_u8(vceqq_u8(data, vOpen), vceqq_u8(data, vClose))));
+        // 4 bits for each character
+        uint64_t mask = vget_lane_u64(
+            vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)),
+            0);
+
+        if (mask != 0) {
+            return offset + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+#endif
+
+    for (; offset < size; offset++) {
+        uint8_t c = buffer[offset];
+
+        if (c == 0x00 || c == seperator || c == quote || c == open ||
+            c == close || c == delimiter) {
+            return offset;
+        }
+    }
+
+    return size;
+}
+
+
+// Add a word to the token index
+// @param  offset   start of word inside the buffer
+void CmdParser::beginToken(size_t offset)
+{
+    if (m_wordCount < CMDPARSER_MAX_TOKENS && offset <= 0xFFFF) {
+        m_tokenOffset[m_wordCount] = offset;
+        m_tokenLength[m_wordCount] = 0;
+    }
+    m_wordCount++;
+}
+
+
+// Close the last word in the token index
+// @param  offset   first byte behind the word
+void CmdParser::endToken(size_t offset)
+{
+    uint16_t idx = m_wordCount - 1;
+
+    if (idx < CMDPARSER_MAX_TOKENS && offset <= 0xFFFF) {
+        m_tokenLength[idx] = offset - m_tokenOffset[idx];
+        m_tokenCount       = idx + 1;
+    }
 }
 
 
@@ -133,12 +501,24 @@ char *CmdParser::getCmdParam(uint16_t idx)
         return NULL;
     }
 
+    // word is in the token index
+    if (m_tokenBase + idx < m_tokenEnd) {
+        return reinterpret_cast<char *>(&m_buffer[m_tokenOffset[m_tokenBase + idx]]);
+    }
+
+    // words are not terminated
+    if (m_keepBuffer) {
+        if(m_errorStr == NULL)
+            m_errorStr = (char *)"Error: parameter not in token index";
+        return NULL;
+    }
+
     // search hole cmd buffer
-    for (size_t i = 0; i < m_bufferSize; i++) {
+    for (size_t i = m_scanBegin; i < m_scanEnd; i++) {
 
         // increment count at the end of each string
         // parameters are separated by NULLs
-        if (i > 0 && m_buffer[i] == 0x00 && m_buffer[i - 1] != 0x00) {
+        if (i > m_scanBegin && m_buffer[i] == 0x00 && m_buffer[i - 1] != 0x00) {
             count++;
         }
 
@@ -155,10 +535,115 @@ char *CmdParser::getCmdParam(uint16_t idx)
 }
 
 
+// Get parameter length
+// @param  parameter number starting from 1; 0=command
+// @return  length of parameter text
+size_t CmdParser::getCmdParamLength(uint16_t idx)
+{
+    char *str;
+
+    // word is in the token index
+    if (idx <= m_paramCount && m_tokenBase + idx < m_tokenEnd) {
+        return m_tokenLength[m_tokenBase + idx];
+    }
+
+    str = this->getCmdParam(idx);
+    if (str == NULL) {
+        return 0;
+    }
+    return strlen(str);
+}
+
+
+// Get parameter as view
+// @param  parameter number starting from 1; 0=command
+// @return  view of parameter text
+CmdParserView CmdParser::getCmdParamView(uint16_t idx)
+{
+    CmdParserView view;
+
+    view.str  = this->getCmdParam(idx);
+    view.size = 0;
+    if (view.str != NULL) {
+        view.size = this->getCmdParamLength(idx);
+    }
+    return view;
+}
+
+
+// Get parameter type
+// @param  parameter number starting from 1; 0=command
+// @return  CMDPARSER_TYPE_TEXT or type of binary param
+uint8_t CmdParser::getCmdParamType(uint16_t idx)
+{
+    // type char is in front of a binary param
+    if (m_binary && idx > 0 && idx <= m_paramCount &&
+        m_tokenBase + idx < m_tokenEnd) {
+        return m_buffer[m_tokenOffset[m_tokenBase + idx] - 1];
+    }
+
+    return CMDPARSER_TYPE_TEXT;
+}
+
+
+uint32_t CmdParser::readUint32(const char *data)
+{
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+
+    return static_cast<uint32_t>(bytes[0]) |
+           static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 |
+           static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+
+// Get parameter as number without a text conversion for binary params
+// @return  CMDPARSER_NUM_INT, _HEX, _FLOAT or _NONE
+uint8_t CmdParser::getParamNumber(uint16_t idx, long *intValue,
+                                  double *floatValue)
+{
+    uint32_t bits = 0;
+    int32_t  binInt;
+    float    binFloat;
+
+    switch (this->getCmdParamType(idx)) {
+    case CMDPARSER_TYPE_INT:
+        bits = readUint32(this->getCmdParam(idx));
+        memcpy(&binInt, &bits, sizeof(binInt));
+        *intValue   = binInt;
+        *floatValue = binInt;
+        return CMDPARSER_NUM_INT;
+    case CMDPARSER_TYPE_FLOAT:
+        bits = readUint32(this->getCmdParam(idx));
+        memcpy(&binFloat, &bits, sizeof(binFloat));
+        *floatValue = binFloat;
+
+        // integer part like strtol
+        if (binFloat >= static_cast<float>(LONG_MAX)) {
+            *intValue = LONG_MAX;
+        } else if (binFloat <= static_cast<float>(LONG_MIN)) {
+            *intValue = LONG_MIN;
+        } else if (binFloat == binFloat) {
+            *intValue = static_cast<long>(binFloat);
+        } else {
+            return CMDPARSER_NUM_NONE;
+        }
+        return CMDPARSER_NUM_FLOAT;
+    default:
+        return this->scanNumber(this->getCmdParam(idx),
+                                this->getCmdParamLength(idx), intValue,
+                                floatValue);
+    }
+}
+
+
 // return parameter idx as a float or double
 double CmdParser::getCmdParamAsFloat(uint16_t idx)
 {
    //char *err_msg = (char *)"Error: Expecting floating point value";
+   long    intValue;
+   double  floatValue;
+   uint8_t type;
 
    // Check for NULL string (this should never happen)
    char *str = this->getCmdParam(idx);
@@ -169,15 +654,16 @@ double CmdParser::getCmdParamAsFloat(uint16_t idx)
    }
 
    // Check for a valid floating point value in the string
-   if( this->floatInStr( str ) ) {  // if str contains a float
-      return( strtod(str, NULL) );          // convert to a float
+   type = this->getParamNumber( idx, &intValue, &floatValue );
+   if( type == CMDPARSER_NUM_FLOAT ) {  // if str contains a float
+      return( floatValue );
    }
    // If this is a valid integer value, give a warning, but
    // return the value
-   if( this->intInStr( str ) ) {    // if str contains an integer
+   if( type == CMDPARSER_NUM_INT ) {    // if str contains an integer
       if(m_warningStr == NULL)
           m_warningStr = (char *)"Warning: expecting float";
-      return( strtod(str, NULL) );          // convert to a float
+      return( floatValue );
    }
 
    // if we get here, a valid number was not found in the string
@@ -229,6 +715,10 @@ double CmdParser::getCmdParamAsFloat(uint16_t idx, double min, double max, uint8
 // return parameter idx as an int or long
 long CmdParser::getCmdParamAsInt(uint16_t idx)
 {
+   long    intValue;
+   double  floatValue;
+   uint8_t type;
+
    // Check for NULL string (this should never happen)
    char *str = this->getCmdParam(idx);
    if( str == NULL ) {
@@ -238,18 +728,19 @@ long CmdParser::getCmdParamAsInt(uint16_t idx)
    }
 
    // Check for a valid integer value in the string
-   if( this->intInStr( str ) ) {  // if str contains an integer value
-      return( strtol(str, NULL, 10) );        // convert to a long
+   type = this->getParamNumber( idx, &intValue, &floatValue );
+   if( type == CMDPARSER_NUM_INT ) {  // if str contains an integer value
+      return( intValue );
    }
-   if( this->hexInStr( str ) ) {  // if str contains an integer value
-      return( strtol(str, NULL, 16) );        // convert to a long
+   if( type == CMDPARSER_NUM_HEX ) {  // if str contains an integer value
+      return( intValue );
    }
    // If this is a valid float value, give a warning, but
    // return the value
-   if( this->floatInStr( str ) ) {    // if str contains a float
+   if( type == CMDPARSER_NUM_FLOAT ) {    // if str contains a float
       if(m_warningStr == NULL)
           m_warningStr = (char *)"Warning: truncated to integer";
-      return( strtol(str, NULL, 10) );          // convert to a long
+      return( intValue );          // integer part
    }
 
    // if we get here, a valid number was not found in the string
@@ -298,12 +789,145 @@ long CmdParser::getCmdParamAsInt(uint16_t idx, long min, long max, uint8_t treat
 }
 
 
+// return many parameters with a list of descriptions
+// @param args     list of param descriptions
+// @param status   optional, status of each param
+// @param size     number of params in list
+// @param first    cmd parameter index of first param (from 1)
+// @return  number of params with errors
+uint16_t CmdParser::getCmdParams(const CmdParserArg *args, uint8_t *status,
+                                 uint16_t size, uint16_t first)
+{
+   uint16_t errors = 0;
+   uint16_t idx;
+   uint8_t  state;
+   uint8_t  type;
+   long     intValue;
+   double   floatValue;
+   char    *str;
+
+   for( uint16_t i = 0; i < size; i++ ) {
+      idx   = first + i;
+      state = CMDPARSER_ARG_OK;
+
+      // missing param
+      if( idx > m_paramCount ) {
+         if( args[i].flags & CMDPARSER_ARG_OPTIONAL ) {
+            state = CMDPARSER_ARG_MISSING;
+         }
+         else {
+            if(m_errorStr == NULL)
+                m_errorStr = (char *)"Error: missing parameter";
+            state = CMDPARSER_ARG_INVALID;
+            errors++;
+         }
+         if( status != NULL )
+            status[i] = state;
+         continue;
+      }
+
+      str = this->getCmdParam( idx );
+      if( args[i].type == CMDPARSER_ARG_STRING ) {
+         *static_cast<char **>(args[i].value) = str;
+         if( status != NULL )
+            status[i] = state;
+         continue;
+      }
+
+      type = this->getParamNumber( idx, &intValue, &floatValue );
+
+      // check the number like getCmdParamAsInt and getCmdParamAsFloat
+      if( type == CMDPARSER_NUM_NONE ) {
+         if(m_errorStr == NULL) {
+             if( args[i].type == CMDPARSER_ARG_INT )
+                m_errorStr = (char *)"Error: not a valid integer number";
+             else
+                m_errorStr = (char *)"Error: not a valid floating point number";
+         }
+         state      = CMDPARSER_ARG_INVALID;
+         intValue   = 0;
+         floatValue = 0.0;
+      }
+      else if( args[i].type == CMDPARSER_ARG_INT && type == CMDPARSER_NUM_FLOAT ) {
+         if(m_warningStr == NULL)
+             m_warningStr = (char *)"Warning: truncated to integer";
+         state = CMDPARSER_ARG_WARNING;
+      }
+      else if( args[i].type == CMDPARSER_ARG_FLOAT && type == CMDPARSER_NUM_HEX ) {
+         if(m_errorStr == NULL)
+             m_errorStr = (char *)"Error: not a valid floating point number";
+         state      = CMDPARSER_ARG_INVALID;
+         floatValue = 0.0;
+      }
+      else if( args[i].type == CMDPARSER_ARG_FLOAT && type == CMDPARSER_NUM_INT ) {
+         if(m_warningStr == NULL)
+             m_warningStr = (char *)"Warning: expecting float";
+         state = CMDPARSER_ARG_WARNING;
+      }
+
+      if( args[i].type == CMDPARSER_ARG_INT ) {
+         floatValue = intValue;
+      }
+
+      // range check
+      if( state != CMDPARSER_ARG_INVALID &&
+          (args[i].flags & (CMDPARSER_ARG_RANGE | CMDPARSER_ARG_RANGE_ERROR)) &&
+          (floatValue < args[i].min || floatValue > args[i].max) ) {
+         if( args[i].flags & CMDPARSER_ARG_RANGE_ERROR ) {
+            if(m_errorStr == NULL)
+                m_errorStr = (char *)"Error: value out of range";
+            state      = CMDPARSER_ARG_INVALID;
+            floatValue = 0.0;
+         }
+         else if( floatValue < args[i].min ) {
+            if(m_warningStr == NULL)
+                m_warningStr = (char *)"Warning: using min value";
+            state      = CMDPARSER_ARG_WARNING;
+            floatValue = args[i].min;
+         }
+         else {
+            if(m_warningStr == NULL)
+                m_warningStr = (char *)"Warning: using max value";
+            state      = CMDPARSER_ARG_WARNING;
+            floatValue = args[i].max;
+         }
+         intValue = static_cast<long>(floatValue);
+      }
+
+      if( state == CMDPARSER_ARG_INVALID ) {
+         intValue = 0;
+         errors++;
+      }
+
+      if( args[i].type == CMDPARSER_ARG_INT )
+         *static_cast<long *>(args[i].value) = intValue;
+      else
+         *static_cast<double *>(args[i].value) = floatValue;
+
+      if( status != NULL )
+         status[i] = state;
+   }
+
+   return errors;
+}
+
+
 char *CmdParser::getValueFromKey(const char *key, bool progmem)
 {
     bool foundKey = false;
     size_t  i;
 
-    for(i=1; i<m_bufferSize; i++) {
+    // search in key index
+    if (m_keyIndex) {
+        return this->getValueViewFromKey(key, progmem).str;
+    }
+
+    // words are not terminated
+    if (m_keepBuffer) {
+        return NULL;
+    }
+
+    for(i=m_scanBegin+1; i<m_scanEnd; i++) {
 
         // find the start of an element
         if (m_buffer[i] != 0 && m_buffer[i-1] == 0x00 && !foundKey) {
@@ -331,6 +955,219 @@ char *CmdParser::getValueFromKey(const char *key, bool progmem)
 }
 
 
+CmdParserView CmdParser::getValueViewFromKey(const char *key, bool progmem)
+{
+    CmdParserView view;
+    uint16_t      idx;
+
+    // search in key index
+    if (m_keyIndex) {
+        idx = this->findKey(key, progmem);
+        if (idx != CMDPARSER_ERROR) {
+            return this->getKeyValue(idx);
+        }
+
+        view.str  = NULL;
+        view.size = 0;
+        return view;
+    }
+
+    view.str  = this->getValueFromKey(key, progmem);
+    view.size = (view.str != NULL) ? strlen(view.str) : 0;
+    return view;
+}
+
+
+// Search lower bound in key index, so first key of command line is found
+// @return  key pair number or CMDPARSER_ERROR
+uint16_t CmdParser::findKey(const char *key, bool progmem)
+{
+    uint16_t first = m_keyBase;
+    uint16_t last  = m_keyBase + m_keyCount;
+    uint16_t mid;
+
+    while (first < last) {
+        mid = first + (last - first) / 2;
+
+        if (this->compareKey(key, progmem, m_keySort[mid]) > 0) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+
+    if (first < m_keyBase + m_keyCount &&
+        this->compareKey(key, progmem, m_keySort[first]) == 0) {
+        return m_keySort[first];
+    }
+    return CMDPARSER_ERROR;
+}
+
+
+// Compare view case insensitive with string
+// @return  true if equal
+bool CmdParser::equalView(CmdParserView view, const char *value, bool progmem)
+{
+    if (view.str == NULL || value == NULL) {
+        return false;
+    }
+
+#if defined(__AVR__) || defined(ESP8266)
+    if (progmem) {
+        return strncasecmp_P(view.str, value, view.size) == 0 &&
+               pgm_read_byte(&value[view.size]) == 0x00;
+    }
+#else
+    (void)progmem;
+#endif
+    return strncasecmp(view.str, value, view.size) == 0 &&
+           value[view.size] == 0x00;
+}
+
+
+// return a key pair in command line order
+// @param idx      key pair number
+// @param key      return start of key, not terminated with '\0'
+// @param keySize  return size of key
+// @param value    return value string
+// @return  true if key pair exists
+bool CmdParser::getKeyValuePair(uint16_t idx, char **key, size_t *keySize,
+                                char **value)
+{
+    if (idx >= m_keyCount) {
+        return false;
+    }
+
+    idx += m_keyBase;
+    *key     = reinterpret_cast<char *>(&m_buffer[m_tokenOffset[m_keyToken[idx]]]);
+    *keySize = m_keySize[idx];
+    *value   = this->getKeyValue(idx).str;
+    return true;
+}
+
+
+// Build key index from all words with KEY=Value, sorted by key for each
+// command of the batch
+void CmdParser::indexKeys()
+{
+    uint8_t *str;
+    uint8_t *eq;
+    uint16_t pos;
+    uint16_t first;
+    uint16_t tokenEnd;
+
+    // words behind the token index are unknown
+    if (m_tokenCount < m_wordCount) {
+        return;
+    }
+
+    for (uint16_t cmd = 0; cmd < m_cmdCount; cmd++) {
+        first    = m_keyTotal;
+        tokenEnd = (cmd + 1u < m_cmdCount) ? m_cmdRecord[cmd + 1].token
+                                           : m_tokenCount;
+        m_cmdRecord[cmd].key = first;
+
+        // first word is the command
+        for (uint16_t idx = m_cmdRecord[cmd].token + 1; idx < tokenEnd; idx++) {
+            str = &m_buffer[m_tokenOffset[idx]];
+            eq  = static_cast<uint8_t *>(
+                memchr(str, CMDPARSER_CHAR_EQ, m_tokenLength[idx]));
+
+            // no key or empty key
+            if (eq == NULL || eq == str) {
+                continue;
+            }
+
+            // key index is full
+            if (m_keyTotal >= CMDPARSER_MAX_KEYS) {
+                return;
+            }
+
+            m_keyToken[m_keyTotal] = idx;
+            m_keySize[m_keyTotal]  = eq - str;
+
+            // insert sorted behind equal keys of this command
+            for (pos = m_keyTotal; pos > first; pos--) {
+                uint16_t prev = m_keySort[pos - 1];
+                size_t   size = m_keySize[prev];
+                int      cmp;
+
+                if (size > m_keySize[m_keyTotal]) {
+                    size = m_keySize[m_keyTotal];
+                }
+                cmp = strncasecmp(reinterpret_cast<char *>(str),
+                                  reinterpret_cast<char *>(
+                                      &m_buffer[m_tokenOffset[m_keyToken[prev]]]),
+                                  size);
+                if (cmp == 0) {
+                    cmp = m_keySize[m_keyTotal] - m_keySize[prev];
+                }
+                if (cmp >= 0) {
+                    break;
+                }
+                m_keySort[pos] = prev;
+            }
+            m_keySort[pos] = m_keyTotal;
+            m_keyTotal++;
+        }
+    }
+
+    m_keyIndex = true;
+}
+
+
+// Compare search key with key of key pair
+// @return  <0, 0 or >0 like strcasecmp
+int CmdParser::compareKey(const char *key, bool progmem, uint16_t idx)
+{
+    uint8_t *str  = &m_buffer[m_tokenOffset[m_keyToken[idx]]];
+    size_t   size = m_keySize[idx];
+    int      c;
+
+    for (size_t i = 0;; i++) {
+#if defined(__AVR__) || defined(ESP8266)
+        c = progmem ? pgm_read_byte(&key[i]) : static_cast<uint8_t>(key[i]);
+#else
+        (void)progmem;
+        c = static_cast<uint8_t>(key[i]);
+#endif
+        if (i == size) {
+            return c;
+        }
+        if (c == 0x00) {
+            return -1;
+        }
+
+        c = tolower(c) - tolower(str[i]);
+        if (c != 0) {
+            return c;
+        }
+    }
+}
+
+
+// Value of key pair is behind '=', or the next word for a empty value
+// i.e. KEY="Value"
+CmdParserView CmdParser::getKeyValue(uint16_t idx)
+{
+    CmdParserView view;
+    uint16_t      token = m_keyToken[idx];
+
+    if (m_keySize[idx] + 1u < m_tokenLength[token]) {
+        view.str  = reinterpret_cast<char *>(
+            &m_buffer[m_tokenOffset[token] + m_keySize[idx] + 1]);
+        view.size = m_tokenLength[token] - m_keySize[idx] - 1;
+    } else if (token + 1u < m_tokenEnd) {
+        view.str  = reinterpret_cast<char *>(&m_buffer[m_tokenOffset[token + 1]]);
+        view.size = m_tokenLength[token + 1];
+    } else {
+        view.str  = NULL;
+        view.size = 0;
+    }
+    return view;
+}
+
+
 // checks string for a leading negative sign
 bool CmdParser::negInStr( char *s )
 {
@@ -346,130 +1183,123 @@ bool CmdParser::negInStr( char *s )
 // checks for a string containing any valid integer or long value
 bool CmdParser::intInStr( char *s )
 {
-   unsigned int i;
-   int digits = 0;
+   long   intValue;
+   double floatValue;
 
    if( s == NULL )
       return false;
 
-   for( i=0; i<strlen(s); i++) {
-      // check for valid charcters
-      if( i == 0 ) { // only valid as first character
-         if( s[i] == '+' ) continue;
-         if( s[i] == '-' ) continue;
-      }
-      if( s[i] >= '0' && s[i] <= '9' ) {
-         digits++;
-         continue;
-      }
-      return false; // exit if any invalid char found
-   }
-   //Serial.print( "size:" );
-   //Serial.print( strlen(s) );
-   //Serial.print( " i:" );
-   //Serial.print( i );
-   //Serial.print( " dig:" );
-   //Serial.println( digits );
-
-   if( digits > 0 )
-      return true;
-   else
-      return false;
+   return( this->scanNumber( s, strlen(s), &intValue, &floatValue ) == CMDPARSER_NUM_INT );
 }
 
 
 // checks for a string containing any valid floating point value
 bool CmdParser::floatInStr( char *s )
 {
-   unsigned int i = 0;
-   int digits = 0;
-   int dec_pt = 0;
+   long   intValue;
+   double floatValue;
 
    if( s == NULL )
       return false;
 
-   // + or - are allowed as first character only
-   if( s[i] == '+' || s[i] == '-' )
-      i++;
-
-   // check for valid charcters
-   for( ; i<strlen(s); i++) {
-      //if( i == 0 ) { // only valid as first character
-      //   if( s[i] == '+' ) continue;
-      //   if( s[i] == '-' ) continue;
-      //}
-      if( s[i] >= '0' && s[i] <= '9' ) {
-         digits++;
-         continue;
-      }
-      if( s[i] == '.' ) {
-         dec_pt++;
-         continue;
-      }
-      return false; // exit if any invalid char found
-   }
-   //Serial.print( "size:" );
-   //Serial.print( strlen(s) );
-   //Serial.print( " i:" );
-   //Serial.print( i );
-   //Serial.print( " dig:" );
-   //Serial.print( digits );
-   //Serial.print( " dec:" );
-   //Serial.println( dec_pt );
-
-   if( digits > 0 && dec_pt == 1 )
-      return true;
-   else
-      return false;
+   return( this->scanNumber( s, strlen(s), &intValue, &floatValue ) == CMDPARSER_NUM_FLOAT );
 }
 
 
-
 // checks for a string containing any valid hexidecimal value
 bool CmdParser::hexInStr( char *s )
 {
-   unsigned int i = 0;
-   int digits = 0;
+   long   intValue;
+   double floatValue;
 
    if( s == NULL )
       return false;
 
+   return( this->scanNumber( s, strlen(s), &intValue, &floatValue ) == CMDPARSER_NUM_HEX );
+}
+
+
+// checks a string for a number and converts it in the same pass
+// integer:  [+-]digits
+// hex:      [+-]0x hexdigits
+// float:    [+-]digits with one decimal point
+// A float or a long integer is converted with strtod, so it is correctly
+// rounded, only short integers are converted in the same pass.
+// @param intValue     value, integer part of a float, saturated at LONG_MIN/MAX
+// @param floatValue   value of float or integer
+// @return  CMDPARSER_NUM_INT, _HEX, _FLOAT or _NONE
+uint8_t CmdParser::scanNumber( const char *s, size_t size, long *intValue, double *floatValue )
+{
+   size_t        i = 0;
+   bool          neg = false;
+   bool          hex = false;
+   int           digits = 0;
+   int           dec_pt = 0;
+   uint8_t       digit;
+   uint8_t       base = 10;
+   unsigned long value = 0;
+   unsigned long limit;
+   double        number = 0.0;
+
+   if( s == NULL )
+      return CMDPARSER_NUM_NONE;
+
    // + or - are allowed as first character only
-   if( s[i] == '+' || s[i] == '-' )
+   if( i < size && (s[i] == '+' || s[i] == '-') ) {
+      neg = ( s[i] == '-' );
       i++;
+   }
+   limit = neg ? static_cast<unsigned long>(LONG_MAX) + 1 : LONG_MAX;
 
    // hexidecimal must start with "0x"
-   if( s[i++] != '0' )
-      return false;
-   if( s[i++] != 'x' )
-      return false;
+   if( i + 1 < size && s[i] == '0' && s[i+1] == 'x' ) {
+      hex  = true;
+      base = 16;
+      i += 2;
+   }
 
-   // check for valid hex charcters
-   for( ; i<strlen(s); i++) {
-      if( s[i] >= '0' && s[i] <= '9' ) {
-         digits++;
-         continue;
-      }
-      if( s[i] >= 'a' && s[i] <= 'f' ) {
-         digits++;
+   // check for valid charcters
+   for( ; i<size; i++) {
+      if( s[i] >= '0' && s[i] <= '9' )
+         digit = s[i] - '0';
+      else if( hex && s[i] >= 'a' && s[i] <= 'f' )
+         digit = s[i] - 'a' + 10;
+      else if( hex && s[i] >= 'A' && s[i] <= 'F' )
+         digit = s[i] - 'A' + 10;
+      else if( !hex && s[i] == '.' ) {
+         dec_pt++;
          continue;
       }
-      if( s[i] >= 'A' && s[i] <= 'F' ) {
-         digits++;
-         continue;
+      else
+         return CMDPARSER_NUM_NONE; // exit if any invalid char found
+
+      digits++;
+
+      // integer part, saturated like strtol
+      if( dec_pt == 0 ) {
+         if( value > (limit - digit) / base )
+            value = limit;
+         else
+            value = value * base + digit;
       }
-      return false; // exit if any invalid char found
+
+      // float value, exact up to DBL_DIG digits
+      if( !hex )
+         number = number * 10.0 + digit;
    }
-   //Serial.print( "size:" );
-   //Serial.print( strlen(s) );
-   //Serial.print( " i:" );
-   //Serial.print( i );
-   //Serial.print( " dig:" );
-   //Serial.println( digits );
-
-   if( digits > 0 )
-      return true;
+
+   if( digits == 0 || dec_pt > 1 )
+      return CMDPARSER_NUM_NONE;
+
+   *intValue   = neg ? static_cast<long>(0UL - value) : static_cast<long>(value);
+   if( !hex && (dec_pt == 1 || digits > DBL_DIG) )
+      *floatValue = strtod( s, NULL );
    else
-      return false;
-}
+      *floatValue = neg ? -number : number;
 
+   if( hex )
+      return CMDPARSER_NUM_HEX;
+   if( dec_pt == 1 )
+      return CMDPARSER_NUM_FLOAT;
+   return CMDPARSER_NUM_INT;
+}
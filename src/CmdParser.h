@@ -14,6 +14,7 @@
 #endif
 
 #include <ctype.h>
+#include <limits.h>
 #include "CmdBuffer.h"
 
 //const uint8_t  CMDPARSER_CHAR_SP = 0x20;  // space
@@ -27,12 +28,167 @@
 //#define CMDPARSER_NO_ID     0xFF    // use with setOptID()
 #define CMDPARSER_RANGE_WARNING   0
 #define CMDPARSER_RANGE_ERROR     1
+#define CMDPARSER_NUM_NONE        0       // @see scanNumber
+#define CMDPARSER_NUM_INT         1
+#define CMDPARSER_NUM_HEX         2
+#define CMDPARSER_NUM_FLOAT       3
+
+// Types of params @see getCmdParamType and parseBinary
+#define CMDPARSER_TYPE_TEXT       0x00    // word of a text line
+#define CMDPARSER_TYPE_INT        'i'     // int32_t, little endian
+#define CMDPARSER_TYPE_FLOAT      'f'     // float, little endian
+#define CMDPARSER_TYPE_STRING     's'     // string with '\0' at end
+
+// Types, flags and status of CmdParserArg @see getCmdParams
+#define CMDPARSER_ARG_INT         0       // value is long *
+#define CMDPARSER_ARG_FLOAT       1       // value is double *
+#define CMDPARSER_ARG_STRING      2       // value is char **
+#define CMDPARSER_ARG_OPTIONAL    0x01    // missing param is not a error
+#define CMDPARSER_ARG_RANGE       0x02    // check min/max, use min/max
+#define CMDPARSER_ARG_RANGE_ERROR 0x04    // check min/max, value out of range is a error
+#define CMDPARSER_ARG_OK          0
+#define CMDPARSER_ARG_MISSING     1
+#define CMDPARSER_ARG_WARNING     2
+#define CMDPARSER_ARG_INVALID     3
+
+// Size of the token index, command word included. Words behind this
+// limit or reaching behind 64 KiB are still counted, but searched in the
+// buffer. The limits change the size of CmdParser, define an override for
+// all sources, i.e. as compiler flag.
+#ifndef CMDPARSER_MAX_TOKENS
+#if defined(__AVR__)
+#define CMDPARSER_MAX_TOKENS      16
+#else
+#define CMDPARSER_MAX_TOKENS      32
+#endif
+#endif
+
+// Size of the key index for KEY=Value params @see setOptKeyValue
+#ifndef CMDPARSER_MAX_KEYS
+#if defined(__AVR__)
+#define CMDPARSER_MAX_KEYS        8
+#else
+#define CMDPARSER_MAX_KEYS        16
+#endif
+#endif
+static_assert(CMDPARSER_MAX_KEYS <= 256, "key index is sorted as uint8_t");
+
+// Number of command records for a batch of commands @see setOptCmdDelimiter
+#ifndef CMDPARSER_MAX_CMDS
+#if defined(__AVR__)
+#define CMDPARSER_MAX_CMDS        4
+#else
+#define CMDPARSER_MAX_CMDS        8
+#endif
+#endif
+
+// Words are searched with SSE2 or NEON if available. Define
+// CMDPARSER_NO_SIMD to use only the portable search.
+//#define CMDPARSER_NO_SIMD
 
 #if defined(__AVR__) || defined(ESP8266)
 typedef PGM_P CmdParserString_P;
 #endif
 typedef const char *CmdParserString;
 
+/**
+ * Part of the command line as pointer and size, the string is not
+ * terminated with '\0' @see setOptKeepBuffer.
+ */
+struct CmdParserView
+{
+    /** Start of string or NULL if not exists */
+    char *str;
+
+    /** Size of string */
+    size_t size;
+};
+
+/**
+ * Record of a command inside a batch @see setOptCmdDelimiter.
+ */
+struct CmdParserRecord
+{
+    /** Word number of the command word */
+    uint16_t token;
+
+    /** First key pair of the command in key index */
+    uint16_t key;
+
+    /** Start of the command inside the buffer */
+    size_t offset;
+};
+
+/**
+ * Description of a param for getCmdParams.
+ */
+struct CmdParserArg
+{
+    /** CMDPARSER_ARG_INT, CMDPARSER_ARG_FLOAT or CMDPARSER_ARG_STRING */
+    uint8_t type;
+
+    /** CMDPARSER_ARG_OPTIONAL, CMDPARSER_ARG_RANGE, CMDPARSER_ARG_RANGE_ERROR */
+    uint8_t flags;
+
+    /** Range of value if a range flag is set */
+    double min;
+    double max;
+
+    /** Pointer to store the value */
+    void *value;
+};
+
+/**
+ * State of the parse loop between two characters, so parsing can be
+ * continued with the next received character @see parseIncremental.
+ */
+struct CmdParserState
+{
+    /** Inside quotes or parentheses */
+    bool isString;
+    bool isInsideParen;
+
+    /** Inside a word */
+    bool isToken;
+
+    /** Do not replace seperators with '\0' */
+    bool keepBuffer;
+};
+
+/**
+ * Parser options fixed at compile time for CmdParserStatic. Branches of
+ * unused options are removed from the parse loop.
+ *
+ * @param SEPERATOR             @see CmdParser::setOptSeperator
+ * @param IGNORE_QUOTE          @see CmdParser::setOptIgnoreQuote
+ * @param OPEN                  @see CmdParser::setOptParens, 0x00 is off
+ * @param CLOSE                 @see CmdParser::setOptParens
+ * @param KEY_VALUE             @see CmdParser::setOptKeyValue
+ * @param DELIMITER             @see CmdParser::setOptCmdDelimiter
+ */
+template <char SEPERATOR = CMDPARSER_CHAR_SP, bool IGNORE_QUOTE = false,
+          char OPEN = 0x00, char CLOSE = 0x00, bool KEY_VALUE = false,
+          char DELIMITER = 0x00>
+struct CmdParserPolicy
+{
+    static constexpr bool isStatic() { return true; }
+    static constexpr char seperator() { return SEPERATOR; }
+    static constexpr bool ignoreQuote() { return IGNORE_QUOTE; }
+    static constexpr bool checkParens() { return OPEN != 0x00; }
+    static constexpr char openParen() { return OPEN; }
+    static constexpr char closeParen() { return CLOSE; }
+    static constexpr bool keyValue() { return KEY_VALUE; }
+    static constexpr char cmdDelimiter() { return DELIMITER; }
+};
+
+/**
+ * Parser options are read from the setOpt functions at runtime.
+ */
+struct CmdParserRuntime : public CmdParserPolicy<>
+{
+    static constexpr bool isStatic() { return false; }
+};
+
 /**
  *
  *
@@ -50,17 +206,43 @@ class CmdParser
      * @warning This function changes the buffer and only this object can handle
      * the new buffer!
      *
+     * With a command delimiter all commands are parsed in one pass and
+     * the first one is selected @see selectCmd.
+     *
      * @param buffer            Buffer with cmd string
      * @param bufferSize        Size of buffer
      * @return                  Number of params or CMDPARSER_ERROR
      */
-    uint16_t parseCmd(uint8_t *buffer, size_t bufferSize);
+    virtual uint16_t parseCmd(uint8_t *buffer, size_t bufferSize);
 
 
+    /**
+     * Parse the complete line of a buffer object. Only the received data
+     * is parsed, not the whole buffer. If the buffer has parsed the line
+     * already while receiving, only the words are terminated
+     * @see CmdBufferObject::setParser. A buffer filled through getBuffer
+     * has no data size, the string up to '\0' is parsed instead.
+     *
+     * @param cmdBuffer         Buffer object with cmd string
+     * @return                  Number of params or CMDPARSER_ERROR
+     */
     uint16_t parseCmd(CmdBufferObject *cmdBuffer)
     {
-        return this->parseCmd(cmdBuffer->getBuffer(),
-                              cmdBuffer->getBufferSize());
+        uint8_t *buffer = cmdBuffer->getBuffer();
+        size_t   size   = cmdBuffer->getDataSize();
+
+        if (this->takeIncremental(buffer, size)) {
+            return m_paramCount;
+        }
+        if (cmdBuffer->isBinary()) {
+            return this->parseBinary(buffer, size);
+        }
+        if (size == 0) {
+            uint8_t *end = static_cast<uint8_t *>(
+                memchr(buffer, 0x00, cmdBuffer->getBufferSize()));
+            size = (end != NULL) ? end - buffer : cmdBuffer->getBufferSize();
+        }
+        return this->parseCmd(buffer, size);
     }
 
     uint16_t parseCmd(char *cmdStr)
@@ -69,6 +251,69 @@ class CmdParser
                               strlen(cmdStr));
     }
 
+    /**
+     * Parse the payload of a binary frame @see CmdBufferObject::setOptBinary.
+     * The payload is the command word with '\0' at end, followed by params
+     * with a type char: CMDPARSER_TYPE_INT or _FLOAT and 4 bytes or
+     * CMDPARSER_TYPE_STRING and a string with '\0' at end.
+     * The buffer is not changed. Numbers are read with getCmdParamAsInt,
+     * getCmdParamAsFloat or getCmdParams without text conversion.
+     *
+     * @param buffer            Buffer with payload
+     * @param bufferSize        Size of payload
+     * @return                  Number of params or CMDPARSER_ERROR
+     */
+    uint16_t parseBinary(uint8_t *buffer, size_t bufferSize);
+
+    /**
+     * Return the number of commands in the parsed buffer.
+     *
+     * @return                  Command count, 0 if parsing failed
+     */
+    uint16_t getCmdCount() { return m_cmdCount; }
+
+    /**
+     * Select command number IDX of a batch. All param and key functions
+     * refer to the selected command. Error and warning messages are kept
+     * for the whole batch.
+     *
+     * @param idx               Command number starting from 0
+     * @return                  Number of params or CMDPARSER_ERROR
+     */
+    uint16_t selectCmd(uint16_t idx);
+
+    /**
+     * Parse a line while receiving, called by CmdBufferObject for each
+     * stored character @see CmdBufferObject::setParser. The buffer is
+     * not changed until parseCmd takes the result, a full parse is done
+     * instead if the line was edited or the token index is too small.
+     *
+     * @param buffer            Line buffer, first character is stored
+     * @param offset            Position of stored character
+     * @param size              Size of complete line
+     */
+    void beginIncremental(uint8_t *buffer);
+    void parseIncremental(size_t offset);
+    void abortIncremental();
+    void endIncremental(size_t size);
+
+    /**
+     * Get the cmd word of the line in receiving, as soon as the word is
+     * complete @see beginIncremental.
+     *
+     * @return                  View of cmd word, str is NULL if not exists
+     */
+    CmdParserView getIncrementalCommand();
+
+    /**
+     * Get number of words of the line in receiving, if the line can be cut
+     * behind the last word: the last character is a seperator outside of
+     * quotes and parentheses. Lines with a cmd delimiter are not cut.
+     *
+     * @return                  Number of words or 0
+     */
+    uint16_t getIncrementalWords();
+
     /**
      * Get the initial command word.
      *
@@ -76,14 +321,48 @@ class CmdParser
      */
     char *getCommand() { return this->getCmdParam(0); }
 
+    /**
+     * Get the initial command word as view.
+     *
+     * @return                  View of cmd word, str is NULL if not exists
+     */
+    CmdParserView getCommandView() { return this->getCmdParamView(0); }
+
     /**
      * Get parameter number IDX from command line.
+     * Words inside CMDPARSER_MAX_TOKENS are read from the token index
+     * without searching the buffer.
      *
      * @param idx               Parameter number
      * @return                  String with param or NULL if not exists
      */
     char *getCmdParam(uint16_t idx);
 
+    /**
+     * Get the length of parameter number IDX from command line.
+     *
+     * @param idx               Parameter number
+     * @return                  Length of param or 0 if not exists
+     */
+    size_t getCmdParamLength(uint16_t idx);
+
+    /**
+     * Get parameter number IDX from command line as view.
+     *
+     * @param idx               Parameter number
+     * @return                  View of param, str is NULL if not exists
+     */
+    CmdParserView getCmdParamView(uint16_t idx);
+
+    /**
+     * Get the type of parameter number IDX. Params of a text line are
+     * always CMDPARSER_TYPE_TEXT.
+     *
+     * @param idx               Parameter number
+     * @return                  CMDPARSER_TYPE_TEXT, _INT, _FLOAT or _STRING
+     */
+    uint8_t getCmdParamType(uint16_t idx);
+
     /**
      * Get parameter number IDX from command line and return as a floating
      * point value.
@@ -98,6 +377,22 @@ class CmdParser
     long getCmdParamAsInt(uint16_t idx);
     long getCmdParamAsInt(uint16_t idx, long min, long max, uint8_t treatAsError = 0);
 
+    /**
+     * Get many parameters at once, described by a list of CmdParserArg.
+     * Values are converted and range checked like getCmdParamAsInt and
+     * getCmdParamAsFloat, a optional value is unchanged if missing.
+     * Check getErrorStr() and getWarningStr() for the first message.
+     *
+     * @param args              List of param descriptions
+     * @param status            Optional list for CMDPARSER_ARG_OK,
+     *                          _MISSING, _WARNING or _INVALID of each param
+     * @param size              Number of params in list
+     * @param first             Parameter number of first param in list
+     * @return                  Number of params with errors, 0 if all okay
+     */
+    uint16_t getCmdParams(const CmdParserArg *args, uint8_t *status,
+                          uint16_t size, uint16_t first = 1);
+
 
     /**
      * Return the total number of parameters in the command line.
@@ -109,6 +404,7 @@ class CmdParser
     /**
      * If KeyValue option is set, search the value from a key pair.
      * KEY=Value i.e. KEY is upper case @see setOptCmdUpper.
+     * Keys are searched binary in the key index, build by parseCmd.
      *
      * @param key               Key for search in cmd
      * @return                  String with value or NULL if not exists
@@ -118,6 +414,37 @@ class CmdParser
         return this->getValueFromKey(key, false);
     }
 
+    /**
+     * If KeyValue option is set, search the value from a key pair as view.
+     *
+     * @param key               Key for search in cmd
+     * @return                  View of value, str is NULL if not exists
+     */
+    CmdParserView getValueViewFromKey(CmdParserString key)
+    {
+        return this->getValueViewFromKey(key, false);
+    }
+
+    /**
+     * If KeyValue option is set, return the number of key pairs.
+     *
+     * @return                  Number of key pairs in key index
+     */
+    uint16_t getKeyValueCount() { return m_keyCount; }
+
+    /**
+     * If KeyValue option is set, get key pair number IDX in order of the
+     * command line. The key is not terminated with '\0'.
+     *
+     * @param idx               Key pair number
+     * @param key               Return start of key
+     * @param keySize           Return size of key
+     * @param value             Return value
+     * @return                  TRUE if key pair exists
+     */
+    bool getKeyValuePair(uint16_t idx, char **key, size_t *keySize,
+                         char **value);
+
     /**
      * Check if param equal with value case sensitive.
      *
@@ -127,11 +454,7 @@ class CmdParser
      */
     bool equalCmdParam(uint16_t idx, CmdParserString value)
     {
-        if (strcasecmp(this->getCmdParam(idx), value) == 0) {
-            return true;
-        }
-
-        return false;
+        return this->equalView(this->getCmdParamView(idx), value, false);
     }
 
     /**
@@ -154,11 +477,8 @@ class CmdParser
      */
     bool equalValueFromKey(CmdParserString key, CmdParserString value)
     {
-        if (strcasecmp(this->getValueFromKey(key, false), value) == 0) {
-            return true;
-        }
-
-        return false;
+        return this->equalView(this->getValueViewFromKey(key, false), value,
+                               false);
     }
 
     /**
@@ -213,6 +533,10 @@ class CmdParser
     // searches string a leading "0x" and valid hex characters
     bool hexInStr( char *s );
 
+    // checks string for a number and converts it in the same pass
+    // @return  CMDPARSER_NUM_INT, _HEX, _FLOAT or _NONE
+    uint8_t scanNumber( const char *s, size_t size, long *intValue, double *floatValue );
+
 
 #if defined(__AVR__) || defined(ESP8266)
 
@@ -229,11 +553,8 @@ class CmdParser
      */
     bool equalValueFromKey_P(CmdParserString key, CmdParserString value)
     {
-        if (strcasecmp_P(this->getValueFromKey(key, true), value) == 0) {
-            return true;
-        }
-
-        return false;
+        return this->equalView(this->getValueViewFromKey(key, true), value,
+                               true);
     }
 
     /**
@@ -241,11 +562,7 @@ class CmdParser
      */
     bool equalCmdParam_P(uint16_t idx, CmdParserString_P value)
     {
-        if (strcasecmp_P(this->getCmdParam(idx), value) == 0) {
-            return true;
-        }
-
-        return false;
+        return this->equalView(this->getCmdParamView(idx), value, true);
     }
 
     /**
@@ -264,7 +581,21 @@ class CmdParser
      *
      * @param onOff             Set option TRUE (on) or FALSE (off)
      */
-    void setOptIgnoreQuote(bool onOff = true) { m_ignoreQuote = onOff; }
+    void setOptIgnoreQuote(bool onOff = true) { if (!m_optFixed) { m_ignoreQuote = onOff; } }
+
+    /**
+     * Set parser option to leave the buffer unchanged.
+     * Default is off
+     *
+     * The parser does not replace seperators and quotes with '\0', so
+     * the buffer can still be logged or forwarded after parsing. Params
+     * are not terminated, use the views i.e. getCmdParamView or the
+     * equal functions. Params behind CMDPARSER_MAX_TOKENS and keys without
+     * key index are not found.
+     *
+     * @param onOff             Set option TRUE (on) or FALSE (off)
+     */
+    void setOptKeepBuffer(bool onOff = true) { m_keepBuffer = onOff; }
 
     /**
      * Set parser option for handling KEY=Value parameter.
@@ -277,7 +608,7 @@ class CmdParser
      *
      * @param onOff             Set option TRUE (on) or FALSE (off)
      */
-    void setOptKeyValue(bool onOff = false) { m_useKeyValue = onOff; }
+    void setOptKeyValue(bool onOff = false) { if (!m_optFixed) { m_useKeyValue = onOff; } }
 
     /**
      * Set parser option for cmd seperator.
@@ -285,7 +616,25 @@ class CmdParser
      *
      * @param seperator         Set character for seperator cmd
      */
-    void setOptSeperator(char seperator) { m_seperator = seperator; }
+    void setOptSeperator(char seperator) { if (!m_optFixed) { m_seperator = seperator; } }
+
+    /**
+     * Get the seperator of words @see setOptSeperator.
+     *
+     * @return                  Seperator character
+     */
+    char getOptSeperator() { return m_seperator; }
+
+    /**
+     * Set parser option for a command delimiter, i.e. ';' to parse
+     * "cmd1;cmd2;cmd3" in one pass. A delimiter inside quotes or
+     * parentheses does not split. Empty commands are skipped and commands
+     * behind CMDPARSER_MAX_CMDS are added to the last one.
+     * Default is off or 0x00
+     *
+     * @param delimiter         Set character for command delimiter
+     */
+    void setOptCmdDelimiter(char delimiter) { if (!m_optFixed) { m_cmdDelimiter = delimiter; } }
 
     /**
      * Set parser option for parentheses.
@@ -294,8 +643,53 @@ class CmdParser
      * @param open          Set character for opening parentheses
      * @param close         Set character for closing parentheses
      */
-    void setOptParens(char open, char close) { m_open_paren = open;  m_close_paren = close; m_checkParens = true; }
+    void setOptParens(char open, char close)
+    {
+        if (!m_optFixed) {
+            m_open_paren  = open;
+            m_close_paren = close;
+            m_checkParens = true;
+        }
+    }
+
+
+  protected:
+    /**
+     * Parse loop with options of POLICY @see CmdParserPolicy.
+     *
+     * @param buffer            Buffer with cmd string
+     * @param bufferSize        Size of buffer
+     * @return                  Number of params or CMDPARSER_ERROR
+     */
+    template <class POLICY>
+    uint16_t parseBuffer(uint8_t *buffer, size_t bufferSize);
+
+    /**
+     * Handle one character of the parse loop.
+     *
+     * @param buffer            Buffer with cmd string
+     * @param i                 Position of character
+     * @param state             State of the parse loop
+     * @return                  FALSE at end of data
+     */
+    template <class POLICY>
+    bool parseChar(uint8_t *buffer, size_t i, CmdParserState *state);
 
+    /**
+     * Handle one character while receiving @see parseIncremental.
+     *
+     * @param buffer            Buffer with cmd string
+     * @param i                 Position of character
+     * @param state             State of the parse loop
+     * @return                  FALSE at end of data
+     */
+    virtual bool parseStep(uint8_t *buffer, size_t i, CmdParserState *state);
+
+    /**
+     * Lock the parser options, the setOpt functions of the syntax are
+     * ignored afterwards @see CmdParserStatic.
+     */
+    void lockOpt() { m_optFixed = true; }
 
   private:
     /** Parser option @see setOptIgnoreQuote */
@@ -304,26 +698,80 @@ class CmdParser
     /** Parser option @see setOptKeyValue */
     bool m_useKeyValue;
 
+    /** Parser option @see setOptKeepBuffer */
+    bool m_keepBuffer;
+
     /** Parser option @see setOptSeperator */
     char m_seperator;
 
+    /** Parser option @see setOptCmdDelimiter */
+    char m_cmdDelimiter;
+
    /** Parser option @see setOptParens */
     bool m_checkParens;
     char m_open_paren;
     char m_close_paren;
 
+    /** Syntax options are locked @see lockOpt */
+    bool m_optFixed;
+
    /** Parser option @see setOptID */
    // uint8_t m_ID;
 
     /** Pointer to cmd buffer */
     uint8_t *m_buffer;
 
-    /** Size of cmd buffer */
+    /** Size of parsed data in cmd buffer */
     size_t m_bufferSize;
 
-    /** Number of parsed params */
+    /** Number of params of the selected command */
     uint16_t m_paramCount;
 
+    /** Number of parsed words of all commands */
+    uint16_t m_wordCount;
+
+    /** Command records of a batch */
+    CmdParserRecord m_cmdRecord[CMDPARSER_MAX_CMDS];
+    uint16_t        m_cmdCount;
+
+    /** Words and buffer range of the selected command */
+    uint16_t m_tokenBase;
+    uint16_t m_tokenEnd;
+    size_t   m_scanBegin;
+    size_t   m_scanEnd;
+
+    /** Token index with start and length of words inside the buffer */
+    uint16_t m_tokenOffset[CMDPARSER_MAX_TOKENS];
+    uint16_t m_tokenLength[CMDPARSER_MAX_TOKENS];
+
+    /** Number of words in the token index */
+    uint16_t m_tokenCount;
+
+    /** Key index with word number and size of key in command line order */
+    uint16_t m_keyToken[CMDPARSER_MAX_KEYS];
+    uint16_t m_keySize[CMDPARSER_MAX_KEYS];
+
+    /** Key index sorted by key */
+    uint8_t  m_keySort[CMDPARSER_MAX_KEYS];
+
+    /** Number of keys in key index */
+    uint16_t m_keyTotal;
+
+    /** Key pairs of the selected command */
+    uint16_t m_keyBase;
+    uint16_t m_keyCount;
+
+    /** Key index is complete */
+    bool     m_keyIndex;
+
+    /** Buffer is a binary payload @see parseBinary */
+    bool     m_binary;
+
+    /** State of parsing while receiving @see parseIncremental */
+    CmdParserState m_state;
+    bool           m_incValid;
+    bool           m_incDone;
+
     /** pointers for parser error messages */
     char *m_errorStr;
     char *m_warningStr;
@@ -335,8 +783,313 @@ class CmdParser
      * @return                  String with value or NULL if not exists
      */
     char *getValueFromKey(const char *key, bool progmem);
+    CmdParserView getValueViewFromKey(const char *key, bool progmem);
+
+    /**
+     * Search a key in the key index.
+     *
+     * @param key               Key for search
+     * @param progmem           TRUE key is store in progmem
+     * @return                  Key pair number or CMDPARSER_ERROR
+     */
+    uint16_t findKey(const char *key, bool progmem);
+
+    /**
+     * Compare a view case insensitive with a string.
+     *
+     * @param view              View to compare
+     * @param value             String to compare
+     * @param progmem           TRUE value is store in progmem
+     * @return                  TRUE is equal
+     */
+    bool equalView(CmdParserView view, const char *value, bool progmem);
+
+    /**
+     * Search the next character the parser must handle.
+     *
+     * @param buffer            Cmd buffer
+     * @param offset            Start of search
+     * @param size              Size of buffer
+     * @return                  Position of character or size if not found
+     */
+    static size_t findSpecialChar(const uint8_t *buffer, size_t offset,
+                                  size_t size, uint8_t seperator,
+                                  uint8_t quote, uint8_t open, uint8_t close,
+                                  uint8_t delimiter);
+
+    /**
+     * Init the parser state for a new buffer.
+     *
+     * @param buffer            Buffer with cmd string
+     * @param bufferSize        Size of buffer
+     * @return                  FALSE if buffer is NULL or empty
+     */
+    bool beginParse(uint8_t *buffer, size_t bufferSize);
+
+    /**
+     * Take the result of parsing while receiving, if it is complete for
+     * this line, and terminate the words.
+     *
+     * @param buffer            Buffer with cmd string
+     * @param bufferSize        Size of data
+     * @return                  TRUE if line is parsed
+     */
+    bool takeIncremental(uint8_t *buffer, size_t bufferSize);
+
+    /**
+     * Check the parser state at the end of data, build the key index and
+     * select the first command.
+     *
+     * @param size              Size of parsed data
+     * @param isString          Parser is inside quotes
+     * @param isInsideParen     Parser is inside parentheses
+     * @param keyValue          Build the key index
+     * @return                  Number of params
+     */
+    uint16_t endParse(size_t size, bool isString, bool isInsideParen,
+                      bool keyValue);
+
+    /**
+     * Handle the token index while parsing.
+     *
+     * @param offset            Position of word start or word end
+     */
+    void beginToken(size_t offset);
+    void endToken(size_t offset);
+
+    /**
+     * Start a new command record while parsing.
+     *
+     * @param offset            Position behind the command delimiter
+     */
+    void beginCmd(size_t offset);
+
+    /**
+     * Set words, buffer range and key pairs of command number IDX.
+     *
+     * @param idx               Command number
+     */
+    void selectRecord(uint16_t idx);
+
+    /**
+     * Build the key index from token index.
+     */
+    void indexKeys();
+
+    /**
+     * Compare a search key with key of key pair number IDX case
+     * insensitive.
+     *
+     * @param key               Key for search
+     * @param progmem           TRUE key is store in progmem
+     * @param idx               Key pair number
+     * @return                  <0, 0 or >0 like strcasecmp
+     */
+    int compareKey(const char *key, bool progmem, uint16_t idx);
+
+    /**
+     * Get value of key pair number IDX.
+     *
+     * @param idx               Key pair number
+     * @return                  View of value, str is NULL if not exists
+     */
+    CmdParserView getKeyValue(uint16_t idx);
+
+    /**
+     * Get a param as number, from text or binary.
+     *
+     * @param idx               Parameter number, must exist
+     * @param intValue          Return value as integer
+     * @param floatValue        Return value as floating point
+     * @return                  CMDPARSER_NUM_INT, _HEX, _FLOAT or _NONE
+     */
+    uint8_t getParamNumber(uint16_t idx, long *intValue, double *floatValue);
+
+    /**
+     * Read 4 bytes of a binary param, little endian.
+     *
+     * @param data              Bytes of param
+     * @return                  Value
+     */
+    static uint32_t readUint32(const char *data);
 
     //char *setErrorStr( char *errPtr );
 };
 
+template <class POLICY>
+uint16_t CmdParser::parseBuffer(uint8_t *buffer, size_t bufferSize)
+{
+    // constant options of a static policy remove the dead branches
+    const bool    fixed       = POLICY::isStatic();
+    const bool    ignoreQuote = fixed ? POLICY::ignoreQuote() : m_ignoreQuote;
+    const bool    checkParens = fixed ? POLICY::checkParens() : m_checkParens;
+    const uint8_t seperator   = fixed ? POLICY::seperator() : m_seperator;
+    const uint8_t delimiter   = fixed ? POLICY::cmdDelimiter() : m_cmdDelimiter;
+    const bool    keyValue    = fixed ? POLICY::keyValue() : m_useKeyValue;
+    const uint8_t quote       = ignoreQuote ? 0x00 : CMDPARSER_CHAR_DQ;
+    const uint8_t open =
+        checkParens ? (fixed ? POLICY::openParen() : m_open_paren) : 0x00;
+    const uint8_t close =
+        checkParens ? (fixed ? POLICY::closeParen() : m_close_paren) : 0x00;
+
+    CmdParserState state = {false, false, false, m_keepBuffer};
+    size_t         i;
+
+    if (!this->beginParse(buffer, bufferSize)) {
+        return CMDPARSER_ERROR;
+    }
+
+    ////
+    // Run Parser
+    for (i = 0; i < bufferSize; i++) {
+
+        // end of data inside the buffer
+        if (!this->template parseChar<POLICY>(buffer, i, &state)) {
+            break;
+        }
+
+        // skip plain characters of the word
+        if (state.isToken) {
+            i = findSpecialChar(buffer, i + 1, bufferSize, seperator, quote,
+                                open, close, delimiter) - 1;
+        }
+    }
+
+    // last word runs up to the end of data
+    if (state.isToken) {
+        this->endToken(i);
+    }
+
+    return this->endParse(i, state.isString, state.isInsideParen, keyValue);
+}
+
+template <class POLICY>
+inline bool CmdParser::parseChar(uint8_t *buffer, size_t i, CmdParserState *state)
+{
+    const bool    fixed       = POLICY::isStatic();
+    const bool    ignoreQuote = fixed ? POLICY::ignoreQuote() : m_ignoreQuote;
+    const bool    checkParens = fixed ? POLICY::checkParens() : m_checkParens;
+    const uint8_t seperator   = fixed ? POLICY::seperator() : m_seperator;
+    const uint8_t openParen   = fixed ? POLICY::openParen() : m_open_paren;
+    const uint8_t closeParen  = fixed ? POLICY::closeParen() : m_close_paren;
+    const uint8_t delimiter   = fixed ? POLICY::cmdDelimiter() : m_cmdDelimiter;
+
+    bool isSplit  = true;
+    bool isCmdEnd = false;
+
+    // end of data inside the buffer
+    if (buffer[i] == 0x00 || m_wordCount == 0xFFFE) {
+        return false;
+    }
+    // remove quotes, but do not remove seperator inside quotes
+    // example string: "Hello world!"
+    else if (!ignoreQuote && buffer[i] == CMDPARSER_CHAR_DQ) {
+        state->isString = !state->isString;
+    }
+    // replace seperator with '\0'
+    else if (!state->isString && !state->isInsideParen &&
+             buffer[i] == seperator) {
+    }
+    // end of command inside a batch
+    else if (!state->isString && !state->isInsideParen &&
+             delimiter != 0x00 && buffer[i] == delimiter) {
+        isCmdEnd = true;
+    }
+    // check for parentheses
+    else if (checkParens && buffer[i] == openParen) {
+        if( state->isInsideParen ==  true ) {
+            if(m_warningStr == NULL)
+                m_warningStr = (char *)"Warning: expected closing parentheses";
+        }
+        else
+            state->isInsideParen = true;
+    }
+    else if (checkParens && buffer[i] == closeParen) {
+        if( state->isInsideParen ==  false ) {
+            if(m_warningStr == NULL)
+                m_warningStr = (char *)"Warning: expected opening parentheses";
+        }
+        else
+            state->isInsideParen = false;
+    }
+    else {
+        isSplit = false;
+    }
+
+    // found start of word, also counts a word at beginning of buffer
+    if (!isSplit && !state->isToken) {
+        this->beginToken(i);
+        state->isToken = true;
+    }
+    // found end of word
+    else if (isSplit) {
+        if (!state->keepBuffer) {
+            buffer[i] = 0x00;
+        }
+        if (state->isToken) {
+            this->endToken(i);
+            state->isToken = false;
+        }
+        if (isCmdEnd) {
+            this->beginCmd(i + 1);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Parser with options fixed at compile time, i.e.
+ * CmdParserStatic<CmdParserPolicy<',', true>> for ',' seperated words
+ * without quotes. Runtime options of POLICY can not be changed, the
+ * setters are ignored if called through a CmdParser reference and
+ * incremental parsing uses POLICY as well.
+ */
+template <class POLICY>
+class CmdParserStatic : public CmdParser
+{
+  public:
+    CmdParserStatic()
+    {
+        // keep options for param and key lookups in sync
+        CmdParser::setOptSeperator(POLICY::seperator());
+        CmdParser::setOptIgnoreQuote(POLICY::ignoreQuote());
+        CmdParser::setOptKeyValue(POLICY::keyValue());
+        CmdParser::setOptCmdDelimiter(POLICY::cmdDelimiter());
+        if (POLICY::checkParens()) {
+            CmdParser::setOptParens(POLICY::openParen(), POLICY::closeParen());
+        }
+
+        // setters reached through a CmdParser reference are ignored
+        this->lockOpt();
+    }
+
+    using CmdParser::parseCmd;
+
+    /**
+     * @see CmdParser::parseCmd
+     */
+    virtual uint16_t parseCmd(uint8_t *buffer, size_t bufferSize)
+    {
+        return this->template parseBuffer<POLICY>(buffer, bufferSize);
+    }
+
+  protected:
+    /**
+     * @see CmdParser::parseStep
+     */
+    virtual bool parseStep(uint8_t *buffer, size_t i, CmdParserState *state)
+    {
+        return this->template parseChar<POLICY>(buffer, i, state);
+    }
+
+  public:
+    /** Options are set by POLICY */
+    void setOptIgnoreQuote(bool onOff = true) = delete;
+    void setOptKeyValue(bool onOff = false)   = delete;
+    void setOptSeperator(char seperator)      = delete;
+    void setOptCmdDelimiter(char delimiter)   = delete;
+    void setOptParens(char open, char close)  = delete;
+};
+
 #endif
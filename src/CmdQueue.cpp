@@ -0,0 +1,86 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include "CmdQueue.h"
+
+CmdQueueObject::CmdQueueObject(uint8_t *data, size_t size)
+    : m_data(data), m_size(size), m_head(0), m_tail(0), m_dropCount(0)
+{
+}
+
+bool CmdQueueObject::write(uint8_t data)
+{
+    CmdQueueIndex head = m_head;
+    CmdQueueIndex next = head + 1;
+
+    if (next >= m_size) {
+        next = 0;
+    }
+
+    // queue is full
+    if (next == this->load(m_tail)) {
+        this->store(m_dropCount, m_dropCount + 1);
+        return false;
+    }
+
+    m_data[head] = data;
+    this->store(m_head, next);
+    return true;
+}
+
+size_t CmdQueueObject::write(const uint8_t *data, size_t size)
+{
+    size_t count;
+
+    for (count = 0; count < size; count++) {
+        if (!this->write(data[count])) {
+            break;
+        }
+    }
+
+    return count;
+}
+
+int CmdQueueObject::read()
+{
+    CmdQueueIndex tail = m_tail;
+    uint8_t       data;
+
+    // queue is empty
+    if (tail == this->load(m_head)) {
+        return -1;
+    }
+
+    data = m_data[tail];
+    this->store(m_tail, (tail + 1 >= m_size) ? 0 : tail + 1);
+    return data;
+}
+
+size_t CmdQueueObject::read(uint8_t *data, size_t size)
+{
+    CmdQueueIndex tail  = m_tail;
+    CmdQueueIndex head  = this->load(m_head);
+    size_t        count = 0;
+
+    while (count < size && tail != head) {
+        data[count++] = m_data[tail];
+        tail          = (tail + 1 >= m_size) ? 0 : tail + 1;
+    }
+
+    this->store(m_tail, tail);
+    return count;
+}
+
+size_t CmdQueueObject::available()
+{
+    CmdQueueIndex head = this->load(m_head);
+    CmdQueueIndex tail = m_tail;
+
+    if (head >= tail) {
+        return head - tail;
+    }
+    return m_size - tail + head;
+}
@@ -0,0 +1,151 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#ifndef _CMDQUEUE_H_
+#define _CMDQUEUE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <Arduino.h>
+
+#if defined(__AVR__)
+// 8 bit access is atomic on AVR, so a queue can hold up to 254 bytes
+// (the storage with the free byte must fit a 8 bit index)
+typedef uint8_t CmdQueueIndex;
+#else
+typedef size_t CmdQueueIndex;
+#endif
+
+/**
+ * Lock free queue for bytes with a single producer, i.e. a interrupt
+ * or reader thread, and a single consumer, i.e. the main loop with
+ * CmdBufferObject::readFromQueue. The queue never blocks, if it is full
+ * new bytes are dropped and counted.
+ */
+class CmdQueueObject
+{
+  public:
+    /**
+     * Set storage of queue.
+     *
+     * @param data          Storage for queue
+     * @param size          Size of storage, queue holds size - 1 bytes
+     */
+    CmdQueueObject(uint8_t *data, size_t size);
+
+    /**
+     * Add a byte to queue. Only call from producer, save for interrupts.
+     *
+     * @param data          Byte to add
+     * @return              TRUE if added or FALSE if queue is full
+     */
+    bool write(uint8_t data);
+
+    /**
+     * Add bytes to queue. Only call from producer, save for interrupts.
+     *
+     * @param data          Bytes to add
+     * @param size          Number of bytes
+     * @return              Number of added bytes
+     */
+    size_t write(const uint8_t *data, size_t size);
+
+    /**
+     * Remove a byte from queue. Only call from consumer.
+     *
+     * @return              Byte or -1 if queue is empty
+     */
+    int read();
+
+    /**
+     * Remove bytes from queue. Only call from consumer.
+     *
+     * @param data          Buffer for bytes
+     * @param size          Size of buffer
+     * @return              Number of bytes
+     */
+    size_t read(uint8_t *data, size_t size);
+
+    /**
+     * Get number of bytes in queue. Only call from consumer.
+     *
+     * @return              Number of bytes
+     */
+    size_t available();
+
+    /**
+     * Get number of bytes dropped because queue was full. The counter
+     * wraps around at the maximum of CmdQueueIndex.
+     *
+     * @return              Number of bytes
+     */
+    size_t getDropCount() { return this->load(m_dropCount); }
+
+  private:
+    /** Read index written by the other side */
+    static CmdQueueIndex load(const CmdQueueIndex &index)
+    {
+#if defined(__AVR__)
+        CmdQueueIndex value = *static_cast<const volatile CmdQueueIndex *>(&index);
+        __asm__ __volatile__("" ::: "memory");
+        return value;
+#else
+        return __atomic_load_n(&index, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    /** Write index for the other side */
+    static void store(CmdQueueIndex &index, CmdQueueIndex value)
+    {
+#if defined(__AVR__)
+        __asm__ __volatile__("" ::: "memory");
+        *static_cast<volatile CmdQueueIndex *>(&index) = value;
+#else
+        __atomic_store_n(&index, value, __ATOMIC_RELEASE);
+#endif
+    }
+
+    /** Storage of queue */
+    uint8_t *m_data;
+
+    /** Size of storage */
+    CmdQueueIndex m_size;
+
+    /** Next position to write, only changed by producer */
+    CmdQueueIndex m_head;
+
+    /** Next position to read, only changed by consumer */
+    CmdQueueIndex m_tail;
+
+    /** Number of dropped bytes, only changed by producer */
+    CmdQueueIndex m_dropCount;
+};
+
+/**
+ *
+ *
+ */
+template <size_t QUEUESIZE>
+class CmdQueue : public CmdQueueObject
+{
+  public:
+    /**
+     * Set storage of queue
+     */
+    CmdQueue() : CmdQueueObject(m_queue, QUEUESIZE + 1)
+    {
+#if defined(__AVR__)
+        static_assert(QUEUESIZE < 255, "CmdQueue on AVR holds up to 254 bytes");
+#endif
+    }
+
+  private:
+    /** Storage of queue, one byte is always free */
+    uint8_t m_queue[QUEUESIZE + 1];
+};
+
+#endif
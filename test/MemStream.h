@@ -0,0 +1,47 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#ifndef _MEMSTREAM_H_
+#define _MEMSTREAM_H_
+
+#include <string>
+
+#include <Arduino.h>
+
+/**
+ * Stream reading a string from memory, written bytes are collected.
+ */
+class MemStream : public Stream
+{
+  public:
+    MemStream(const std::string &data) : m_data(data), m_pos(0) {}
+
+    virtual int available() { return m_data.size() - m_pos; }
+    virtual int read()
+    {
+        return m_pos < m_data.size() ? static_cast<uint8_t>(m_data[m_pos++])
+                                     : -1;
+    }
+    virtual int peek()
+    {
+        return m_pos < m_data.size() ? static_cast<uint8_t>(m_data[m_pos])
+                                     : -1;
+    }
+    virtual size_t write(uint8_t data)
+    {
+        m_out.push_back(data);
+        return 1;
+    }
+
+    /** Written bytes */
+    std::string m_out;
+
+  private:
+    std::string m_data;
+    size_t      m_pos;
+};
+
+#endif
@@ -0,0 +1,15 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ *
+ * Run the Benchmark sketch on the host, results are printed to stdout.
+ */
+
+#include "../examples/Benchmark/Benchmark.ino"
+
+int main()
+{
+    setup();
+    return 0;
+}
@@ -0,0 +1,16 @@
+# Run two programs and fail if the output is not the same.
+#   cmake -DFIRST=<program> -DSECOND=<program> -P compare_output.cmake
+
+execute_process(COMMAND ${FIRST} OUTPUT_VARIABLE first RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${FIRST} failed: ${result}")
+endif()
+
+execute_process(COMMAND ${SECOND} OUTPUT_VARIABLE second RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${SECOND} failed: ${result}")
+endif()
+
+if(NOT first STREQUAL second)
+    message(FATAL_ERROR "output differs:\n${FIRST}:\n${first}\n${SECOND}:\n${second}")
+endif()
@@ -0,0 +1,102 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+
+static std::chrono::steady_clock::time_point startTime =
+    std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - startTime)
+        .count();
+}
+
+unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - startTime)
+        .count();
+}
+
+void yield() { std::this_thread::yield(); }
+
+size_t Print::print(const char *str)
+{
+    size_t size = 0;
+
+    while (*str != 0x00) {
+        size += this->write(static_cast<uint8_t>(*str++));
+    }
+    return size;
+}
+
+size_t Print::print(char value) { return this->write(value); }
+
+size_t Print::print(long value)
+{
+    char str[24];
+    snprintf(str, sizeof(str), "%ld", value);
+    return this->print(str);
+}
+
+size_t Print::print(unsigned long value)
+{
+    char str[24];
+    snprintf(str, sizeof(str), "%lu", value);
+    return this->print(str);
+}
+
+size_t Print::print(double value)
+{
+    char str[48];
+    snprintf(str, sizeof(str), "%.2f", value);
+    return this->print(str);
+}
+
+int Stream::timedRead()
+{
+    unsigned long start = millis();
+    int           data;
+
+    do {
+        data = this->read();
+        if (data >= 0) {
+            return data;
+        }
+    } while (millis() - start < m_timeout);
+
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+    size_t count = 0;
+    int    data;
+
+    while (count < length && (data = this->timedRead()) >= 0) {
+        buffer[count++] = static_cast<char>(data);
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+    size_t count = 0;
+    int    data;
+
+    while (count < length && (data = this->timedRead()) >= 0 &&
+           data != terminator) {
+        buffer[count++] = static_cast<char>(data);
+    }
+    return count;
+}
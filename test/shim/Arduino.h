@@ -0,0 +1,109 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ *
+ * Minimal Arduino API for building the library and the examples on a host.
+ */
+
+#ifndef _ARDUINO_SHIM_H_
+#define _ARDUINO_SHIM_H_
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// flash is memory on a host, as on cores without PROGMEM
+typedef const char *PGM_P;
+#define PROGMEM
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define strcasecmp_P strcasecmp
+#define strncasecmp_P strncasecmp
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+unsigned long millis();
+unsigned long micros();
+void          yield();
+
+/**
+ * Output of text and numbers, as Arduino Print.
+ */
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t data) = 0;
+
+    size_t print(const char *str);
+    size_t print(const __FlashStringHelper *str)
+    {
+        return this->print(reinterpret_cast<const char *>(str));
+    }
+    size_t print(char value);
+    size_t print(int value) { return this->print(static_cast<long>(value)); }
+    size_t print(unsigned int value)
+    {
+        return this->print(static_cast<unsigned long>(value));
+    }
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value);
+
+    template <class T>
+    size_t println(T value)
+    {
+        size_t size = this->print(value);
+        return size + this->println();
+    }
+    size_t println() { return this->print("\n"); }
+};
+
+/**
+ * Input of bytes, as Arduino Stream.
+ */
+class Stream : public Print
+{
+  public:
+    Stream() : m_timeout(1000) {}
+
+    virtual int  available() = 0;
+    virtual int  read()      = 0;
+    virtual int  peek()      = 0;
+    virtual void flush() {}
+
+    void   setTimeout(unsigned long timeout) { m_timeout = timeout; }
+    size_t readBytes(char *buffer, size_t length);
+    size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+  protected:
+    int timedRead();
+
+    unsigned long m_timeout;
+};
+
+/**
+ * Serial port writing to stdout, without input.
+ */
+class HostSerial : public Stream
+{
+  public:
+    void           begin(unsigned long) {}
+    virtual int    available() { return 0; }
+    virtual int    read() { return -1; }
+    virtual int    peek() { return -1; }
+    virtual size_t write(uint8_t data)
+    {
+        return fputc(data, stdout) == EOF ? 0 : 1;
+    }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,128 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <string>
+
+#include <CmdArena.h>
+#include <CmdParser.h>
+
+static bool feed(CmdBufferObject *cmdBuffer, const std::string &data)
+{
+    return cmdBuffer->readChars(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+// two buffers receive lines from one arena at the same time
+static void testShared()
+{
+    CmdArena<8, 10> arena;
+    CmdArenaBuffer  bufferA(&arena);
+    CmdArenaBuffer  bufferB(&arena);
+    CmdParser       cmdParser;
+    std::string     lineA = "set alpha=1 beta=2";
+    std::string     lineB = "led on 255 128 64";
+
+    assert(arena.getFreeBlocks() == 10);
+    assert(arena.getMaxLine() == 79);
+    assert(bufferA.getDataSize() == 0);
+    assert(bufferA.getBuffer()[0] == 0x00);
+
+    // interleaved lines grow in turn, so runs are moved
+    for (size_t i = 0; i < lineA.size(); i++) {
+        assert(!feed(&bufferA, lineA.substr(i, 1)));
+        if (i < lineB.size()) {
+            assert(!feed(&bufferB, lineB.substr(i, 1)));
+        }
+    }
+    assert(feed(&bufferA, "\n"));
+    assert(feed(&bufferB, "\n"));
+    assert(strcmp(bufferA.getStringFromBuffer(), lineA.c_str()) == 0);
+    assert(strcmp(bufferB.getStringFromBuffer(), lineB.c_str()) == 0);
+    assert(arena.getFreeBlocks() == 10 - 3 - 3);
+
+    cmdParser.setOptKeyValue(true);
+    assert(cmdParser.parseCmd(&bufferA) == 2);
+    assert(strcmp(cmdParser.getValueFromKey("beta"), "2") == 0);
+
+    bufferA.clear();
+    bufferB.clear();
+    assert(arena.getFreeBlocks() == 10);
+    assert(bufferA.getBuffer()[0] == 0x00);
+}
+
+// a line grows in place and is moved behind a line of a other buffer
+static void testMove()
+{
+    CmdArena<8, 10> arena;
+    CmdArenaBuffer  bufferA(&arena);
+    CmdArenaBuffer  bufferB(&arena);
+    uint8_t *       line;
+
+    assert(!feed(&bufferA, "grow"));
+    line = bufferA.getBuffer();
+    assert(!feed(&bufferA, " in place"));
+    assert(bufferA.getBuffer() == line);
+    assert(arena.getFreeBlocks() == 8);
+
+    assert(!feed(&bufferB, "hold"));
+    assert(!feed(&bufferA, " and move"));
+    assert(bufferA.getBuffer() != line);
+    assert(feed(&bufferA, "\n"));
+    assert(strcmp(bufferA.getStringFromBuffer(), "grow in place and move") ==
+           0);
+
+    assert(feed(&bufferB, "\n"));
+    assert(strcmp(bufferB.getStringFromBuffer(), "hold") == 0);
+
+    bufferA.clear();
+    bufferB.clear();
+    assert(arena.getFreeBlocks() == 10);
+}
+
+// lines are cut at the maximum and at the end of the arena
+static void testOverflow()
+{
+    CmdArena<8, 10> arena;
+    CmdArenaBuffer  bufferA(&arena);
+    CmdArenaBuffer  bufferB(&arena);
+
+    // like CmdBuffer the end char needs room
+    arena.setMaxLine(20);
+    assert(feed(&bufferA, std::string(19, 'x') + "\n"));
+    assert(bufferA.getDataSize() == 19);
+    bufferA.clear();
+    assert(arena.getFreeBlocks() == 10);
+
+    // overflow drops the line, the rest is a new line
+    assert(feed(&bufferA, std::string(20, 'x') + "yz\n"));
+    assert(strcmp(bufferA.getStringFromBuffer(), "yz") == 0);
+    bufferA.clear();
+    assert(arena.getFreeBlocks() == 10);
+
+    // a full arena cuts the line of the other buffer
+    arena.setMaxLine(79);
+    assert(!feed(&bufferA, std::string(60, 'a')));
+    assert(arena.getFreeBlocks() == 2);
+    assert(feed(&bufferB, std::string(15, 'b') + "ok\n"));
+    assert(strcmp(bufferB.getStringFromBuffer(), "ok") == 0);
+    bufferB.clear();
+    assert(arena.getFreeBlocks() == 2);
+
+    assert(feed(&bufferA, "\n"));
+    assert(bufferA.getDataSize() == 60);
+    bufferA.clear();
+    assert(arena.getFreeBlocks() == 10);
+}
+
+int main()
+{
+    testShared();
+    testMove();
+    testOverflow();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <string>
+
+#include <CmdBuffer.h>
+#include <CmdCallback.h>
+#include <CmdParser.h>
+
+#include "MemStream.h"
+
+static std::string called;
+
+static void funct(CmdParser *cmdParser)
+{
+    CmdParserView cmdView = cmdParser->getCommandView();
+
+    called.append(cmdView.str, cmdView.size);
+    called += ",";
+}
+
+static void run(CmdCallbackObject *cmdCallback, const char *data,
+                bool keepBuffer)
+{
+    CmdBuffer<32> cmdBuffer;
+    CmdParser     cmdParser;
+    MemStream     serial(data);
+
+    cmdParser.setOptKeepBuffer(keepBuffer);
+    called.clear();
+    while (serial.available()) {
+        cmdCallback->updateCmdProcessing(&cmdParser, &cmdBuffer, &serial);
+    }
+}
+
+// commands are found without a terminated cmd word in all stores
+static void testKeepBuffer()
+{
+    static constexpr CmdCallbackEntry table[] = {{"led", funct},
+                                                 {"leds", funct}};
+
+    const char *        data   = "led on\nLEDS 1 2\nle\nledsx\n\"led\" x\n";
+    const char *        cmds[] = {"a1", "a2", "a3", "a4", "a5",
+                           "a6", "a7", "a8", "leds", "led"};
+    CmdCallback<10>     cmdCallback;
+    CmdCallbackHash<10> cmdHash;
+    CmdCallbackTrie<10> cmdTrie;
+    CmdCallbackTable    cmdTable(table);
+
+    for (const char *cmd : cmds) {
+        assert(cmdCallback.addCmd(cmd, funct));
+        assert(cmdHash.addCmd(cmd, funct));
+        assert(cmdTrie.addCmd(cmd, funct));
+    }
+
+    for (bool keepBuffer : {false, true}) {
+        run(&cmdCallback, data, keepBuffer);
+        assert(called == "led,LEDS,led,");
+        run(&cmdHash, data, keepBuffer);
+        assert(called == "led,LEDS,led,");
+        run(&cmdTrie, data, keepBuffer);
+        assert(called == "led,LEDS,led,");
+
+        CmdBuffer<32> cmdBuffer;
+        CmdParser     cmdParser;
+        MemStream     serial(data);
+
+        cmdParser.setOptKeepBuffer(keepBuffer);
+        called.clear();
+        while (serial.available()) {
+            cmdTable.updateCmdProcessing(&cmdParser, &cmdBuffer, &serial);
+        }
+        assert(called == "led,LEDS,led,");
+    }
+
+    assert(cmdCallback.findStoreCmd("leds") == 8);
+    assert(cmdCallback.findStoreCmd("led ", 3) == 9);
+    assert(cmdHash.findStoreCmd("LED on", 3) == 9);
+    assert(cmdTable.findStoreCmd("leds", 3) == 0);
+    assert(cmdTable.findStoreCmd("le", 2) == CMDCALLBACK_NO_CMD);
+}
+
+// bytes above 0x7F are hashed as unsigned char
+static void testHashHighBytes()
+{
+    CmdCallbackHash<4> cmdHash;
+
+    assert(cmdHash.addCmd("gr\xFC\xDF", funct));
+    assert(cmdHash.addCmd("GRUSS", funct));
+    assert(cmdHash.findStoreCmd("gr\xFC\xDF") == 0);
+    assert(cmdHash.findStoreCmd("gruss") == 1);
+    assert(CmdCallbackObject::hashCmd("\xC4x", 2) ==
+           CmdCallbackObject::hashCmd("\xC4X", 2));
+}
+
+// exact, unique prefix and ambiguous matches of the trie
+static void testTrieMatch()
+{
+    CmdCallbackTrie<8> cmdTrie;
+    size_t             idx = CMDCALLBACK_NO_CMD;
+
+    assert(cmdTrie.addCmd("start", funct));
+    assert(cmdTrie.addCmd("status", funct));
+    assert(cmdTrie.addCmd("stop", funct));
+    assert(cmdTrie.addCmd("st", funct));
+    assert(cmdTrie.addCmd("reset", funct));
+    assert(cmdTrie.addCmd("\xC4nd", funct));
+    assert(!cmdTrie.addCmd("", funct));
+
+    assert(cmdTrie.matchCmd("STATUS", &idx) == CMDCALLBACK_MATCH_EXACT);
+    assert(idx == 1);
+    assert(cmdTrie.matchCmd("st", &idx) == CMDCALLBACK_MATCH_EXACT);
+    assert(idx == 3);
+    assert(cmdTrie.matchCmd("stat", &idx) == CMDCALLBACK_MATCH_PREFIX);
+    assert(idx == 1);
+    assert(cmdTrie.matchCmd("Sto", &idx) == CMDCALLBACK_MATCH_PREFIX);
+    assert(idx == 2);
+    assert(cmdTrie.matchCmd("r", &idx) == CMDCALLBACK_MATCH_PREFIX);
+    assert(idx == 4);
+    assert(cmdTrie.matchCmd("sta") == CMDCALLBACK_MATCH_AMBIGUOUS);
+    assert(cmdTrie.matchCmd("s") == CMDCALLBACK_MATCH_AMBIGUOUS);
+    assert(cmdTrie.matchCmd("stopp") == CMDCALLBACK_MATCH_NONE);
+    assert(cmdTrie.matchCmd("x") == CMDCALLBACK_MATCH_NONE);
+    assert(cmdTrie.matchCmd("") == CMDCALLBACK_MATCH_NONE);
+    assert(cmdTrie.matchCmd(NULL) == CMDCALLBACK_MATCH_NONE);
+    assert(cmdTrie.matchCmd("\xC4ND", &idx) == CMDCALLBACK_MATCH_EXACT);
+    assert(idx == 5);
+
+    // abbreviations are processed only with setOptPrefix
+    assert(cmdTrie.findStoreCmd("stat") == CMDCALLBACK_NO_CMD);
+    assert(cmdTrie.findStoreCmd("st") == 3);
+    cmdTrie.setOptPrefix();
+    assert(cmdTrie.findStoreCmd("stat") == 1);
+    assert(cmdTrie.findStoreCmd("sta") == CMDCALLBACK_NO_CMD);
+    assert(cmdTrie.findStoreCmd("stop now", 3) == 2);
+}
+
+int main()
+{
+    testKeepBuffer();
+    testHashHighBytes();
+    testTrieMatch();
+    return 0;
+}
@@ -0,0 +1,131 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include <CmdBuffer.h>
+
+static std::string nmea(const std::string &line)
+{
+    uint8_t sum = 0;
+    char    trailer[8];
+
+    for (char c : line) {
+        sum ^= static_cast<uint8_t>(c);
+    }
+    snprintf(trailer, sizeof(trailer), "*%02X", sum);
+    return trailer;
+}
+
+static std::string crc(const std::string &line)
+{
+    uint16_t sum = CMDBUFFER_CRC_INIT;
+    char     trailer[8];
+
+    for (char c : line) {
+        sum = CmdBufferObject::crc16(sum, static_cast<uint8_t>(c));
+    }
+    snprintf(trailer, sizeof(trailer), "*%04x", sum);
+    return trailer;
+}
+
+// feed a line and check the result, a good line must follow a bad one
+static void check(CmdBufferObject *cmdBuffer, const std::string &data,
+                  const char *line)
+{
+    bool found = cmdBuffer->readChars(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size());
+
+    if (line == NULL) {
+        assert(!found);
+    } else {
+        assert(found);
+        assert(strcmp(cmdBuffer->getStringFromBuffer(), line) == 0);
+    }
+    cmdBuffer->clear();
+}
+
+static void testNmea()
+{
+    CmdBuffer<16> cmdBuffer;
+    std::string   trailer = nmea("led on");
+
+    cmdBuffer.setOptChecksum(CMDBUFFER_CHECK_NMEA);
+    assert(cmdBuffer.getOptChecksum() == CMDBUFFER_CHECK_NMEA);
+
+    check(&cmdBuffer, "led on" + trailer + "\n", "led on");
+    check(&cmdBuffer, "led on*00\n", NULL);
+    check(&cmdBuffer, "led on" + trailer + "\n", "led on");
+
+    // missing '*', digits are data then
+    check(&cmdBuffer, "led on\n", NULL);
+    check(&cmdBuffer, "led on" + trailer.substr(1) + "\n", NULL);
+
+    // too few, too many and not hex digits
+    check(&cmdBuffer, "led on" + trailer.substr(0, 2) + "\n", NULL);
+    check(&cmdBuffer, "led on" + trailer + "0\n", NULL);
+    check(&cmdBuffer, "led on*G" + trailer.substr(2) + "\n", NULL);
+    check(&cmdBuffer, "led on" + trailer + "\n", "led on");
+
+    // backspace inside the trailer and over '*'
+    check(&cmdBuffer, "led on" + trailer.substr(0, 2) + "0\b" +
+                          trailer.substr(2) + "\n",
+          "led on");
+    check(&cmdBuffer, "led o*\bn" + trailer.substr(0, 2) + "\b\b" +
+                          trailer + "\n",
+          "led on");
+    check(&cmdBuffer, "led on" + trailer + "\b\b\b\n", NULL);
+
+    // start char is not in the checksum
+    cmdBuffer.setStartChar('$');
+    check(&cmdBuffer, "$led on" + trailer + "\n", "led on");
+}
+
+static void testCrc16()
+{
+    CmdBuffer<16> cmdBuffer;
+    std::string   trailer = crc("set x 1");
+
+    cmdBuffer.setOptChecksum(CMDBUFFER_CHECK_CRC16);
+
+    check(&cmdBuffer, "set x 1" + trailer + "\n", "set x 1");
+    check(&cmdBuffer, "set x 2" + trailer + "\n", NULL);
+    check(&cmdBuffer, "set x 1" + nmea("set x 1") + "\n", NULL);
+    check(&cmdBuffer, "set x 1" + trailer + "0\n", NULL);
+
+    // CRC is calculated again after a backspace
+    check(&cmdBuffer, "set x 2\b1" + trailer + "\n", "set x 1");
+    check(&cmdBuffer, "set x 1" + trailer.substr(0, 4) + "\b\b" +
+                          trailer.substr(2) + "\n",
+          "set x 1");
+}
+
+// the trailer is not stored, but a full buffer drops the line before it
+static void testOverflow()
+{
+    CmdBuffer<16> cmdBuffer;
+    std::string   full(15, 'x');
+    std::string   over = full + "yz";
+
+    cmdBuffer.setOptChecksum(CMDBUFFER_CHECK_NMEA);
+
+    check(&cmdBuffer, full + nmea(full) + "\n", full.c_str());
+    check(&cmdBuffer, over + nmea(over) + "\n", NULL);
+    check(&cmdBuffer, over.substr(0, 16) + nmea(over.substr(0, 16)) + "\n",
+          NULL);
+    check(&cmdBuffer, full + nmea(full) + "\n", full.c_str());
+}
+
+int main()
+{
+    testNmea();
+    testCrc16();
+    testOverflow();
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <string>
+
+#include <CmdBuffer.h>
+#include <CmdFrame.h>
+#include <CmdParser.h>
+
+#include "MemStream.h"
+
+// payload bytes 0xC0 and 0xDB must be escaped
+static const int32_t TEST_INT   = static_cast<int32_t>(0xDB01C0FE);
+static const char *  TEST_STR   = "x\xDB\xC0y";
+static const float   TEST_FLOAT = 0.5f;
+
+static std::string frame(const char *cmdStr)
+{
+    MemStream out("");
+    CmdFrame  cmdFrame(&out);
+
+    cmdFrame.beginFrame(cmdStr);
+    cmdFrame.addInt(TEST_INT);
+    cmdFrame.addFloat(TEST_FLOAT);
+    cmdFrame.addString(TEST_STR);
+    cmdFrame.endFrame();
+
+    return out.m_out;
+}
+
+static bool feed(CmdBufferObject *cmdBuffer, const std::string &data)
+{
+    return cmdBuffer->readChars(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+static void checkParams(CmdParser *cmdParser)
+{
+    assert(strcmp(cmdParser->getCommand(), "speed") == 0);
+    assert(cmdParser->getCmdParamType(0) == CMDPARSER_TYPE_TEXT);
+    assert(cmdParser->getCmdParamType(1) == CMDPARSER_TYPE_INT);
+    assert(cmdParser->getCmdParamType(2) == CMDPARSER_TYPE_FLOAT);
+    assert(cmdParser->getCmdParamType(3) == CMDPARSER_TYPE_STRING);
+    assert(cmdParser->getCmdParamAsInt(1) == TEST_INT);
+    assert(cmdParser->getCmdParamAsFloat(2) == TEST_FLOAT);
+    assert(strcmp(cmdParser->getCmdParam(3), TEST_STR) == 0);
+}
+
+// a frame is escaped, read from a stream and parsed
+static void testRoundTrip()
+{
+    std::string   data = frame("speed");
+    MemStream     serial(std::string("noise") + data + data);
+    CmdBuffer<32> cmdBuffer;
+    CmdParser     cmdParser;
+
+    // no raw END or ESC inside the frame
+    assert(data[0] == '\xC0' && data[data.size() - 1] == '\xC0');
+    assert(data.find('\xC0', 1) == data.size() - 1);
+    assert(data.find("\xDB\xDC") != std::string::npos);
+    assert(data.find("\xDB\xDD") != std::string::npos);
+
+    // int is little endian on the wire
+    assert(data.find("i\xFE\xDB\xDC\x01\xDB\xDD") != std::string::npos);
+
+    cmdBuffer.setOptBinary();
+    assert(cmdBuffer.isBinary());
+    for (int i = 0; i < 2; i++) {
+        assert(cmdBuffer.readFromSerial(&serial));
+        assert(cmdParser.parseCmd(&cmdBuffer) == 3);
+        checkParams(&cmdParser);
+        cmdBuffer.clear();
+    }
+    assert(serial.available() == 0);
+}
+
+// broken frames are dropped and the next frame is read
+static void testBrokenFrames()
+{
+    std::string   data = frame("speed");
+    std::string   bad;
+    CmdBuffer<32> cmdBuffer;
+    CmdParser     cmdParser;
+
+    cmdBuffer.setOptBinary();
+
+    // bad CRC
+    bad = data;
+    bad[2] ^= 0x01;
+    assert(!feed(&cmdBuffer, bad));
+
+    // escape byte at end of frame
+    bad = data;
+    bad.insert(bad.size() - 1, "\xDB");
+    assert(!feed(&cmdBuffer, bad));
+
+    // corrupted frame with a invalid escape sequence
+    bad = data;
+    bad.insert(4, "\xDBx");
+    assert(!feed(&cmdBuffer, bad));
+
+    // empty frames and a frame with CRC only
+    assert(!feed(&cmdBuffer, "\xC0\xC0\x01\xC0"));
+
+    assert(feed(&cmdBuffer, data));
+    assert(cmdParser.parseCmd(&cmdBuffer) == 3);
+    checkParams(&cmdParser);
+}
+
+// a frame longer than the buffer is dropped up to the next END
+static void testOverflow()
+{
+    MemStream     out("");
+    CmdFrame      cmdFrame(&out);
+    CmdBuffer<16> cmdBuffer;
+    CmdParser     cmdParser;
+
+    cmdBuffer.setOptBinary();
+    assert(!feed(&cmdBuffer, frame("speed")));
+
+    cmdFrame.beginFrame("a");
+    cmdFrame.addInt(-1);
+    cmdFrame.endFrame();
+    assert(feed(&cmdBuffer, out.m_out));
+    assert(cmdParser.parseCmd(&cmdBuffer) == 1);
+    assert(strcmp(cmdParser.getCommand(), "a") == 0);
+    assert(cmdParser.getCmdParamAsInt(1) == -1);
+}
+
+int main()
+{
+    testRoundTrip();
+    testBrokenFrames();
+    testOverflow();
+    return 0;
+}
@@ -0,0 +1,60 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+
+#include <CmdParser.h>
+
+static double parseFloat(const char *number)
+{
+    CmdParser cmdParser;
+    char      line[64];
+
+    snprintf(line, sizeof(line), "set %s", number);
+    assert(cmdParser.parseCmd(line) != CMDPARSER_ERROR);
+    return cmdParser.getCmdParamAsFloat(1);
+}
+
+// floats and long integers are rounded like strtod
+static void testRounding()
+{
+    std::mt19937 rng(9);
+    char         number[40];
+
+    for (int i = 0; i < 20000; i++) {
+        size_t size   = 1 + rng() % 24;
+        size_t dec_pt = rng() % (size + 1);
+        size_t pos    = 0;
+
+        if (rng() & 1) {
+            number[pos++] = '-';
+        }
+        for (size_t j = 0; j < size; j++) {
+            if (j == dec_pt) {
+                number[pos++] = '.';
+            }
+            number[pos++] = '0' + rng() % 10;
+        }
+        number[pos] = 0x00;
+
+        assert(parseFloat(number) == strtod(number, NULL));
+    }
+
+    assert(parseFloat("0.1") == 0.1);
+    assert(parseFloat("2.675") == 2.675);
+    assert(parseFloat("123456789012345678") == 123456789012345678.0);
+}
+
+int main()
+{
+    testRounding();
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <string>
+
+#include <CmdBuffer.h>
+#include <CmdParser.h>
+
+#include "MemStream.h"
+
+typedef CmdParserStatic<CmdParserPolicy<',', true>> CommaParser;
+
+// runtime setters reached through the base class keep the policy
+static void testStaticOptions()
+{
+    CommaParser cmdStatic;
+    CmdParser & cmdParser = cmdStatic;
+    char        line[]    = "set,\"a b\",2";
+
+    cmdParser.setOptSeperator(' ');
+    cmdParser.setOptIgnoreQuote(false);
+    cmdParser.setOptKeyValue(true);
+    cmdParser.setOptCmdDelimiter(';');
+    cmdParser.setOptParens('(', ')');
+    assert(cmdParser.getOptSeperator() == ',');
+
+    assert(cmdParser.parseCmd(line) == 2);
+    assert(strcmp(cmdParser.getCmdParam(1), "\"a b\"") == 0);
+    assert(strcmp(cmdParser.getCmdParam(2), "2") == 0);
+}
+
+// parsing while receiving uses the policy of a static parser
+static void testStaticIncremental()
+{
+    CmdBuffer<32> cmdBuffer;
+    CommaParser   cmdParser;
+    MemStream     serial("set,\"a b\",2\n");
+
+    static_cast<CmdParser &>(cmdParser).setOptSeperator(' ');
+    cmdBuffer.setParser(&cmdParser);
+    assert(cmdBuffer.readFromSerial(&serial));
+    assert(cmdParser.parseCmd(&cmdBuffer) == 2);
+    assert(strcmp(cmdParser.getCommand(), "set") == 0);
+    assert(strcmp(cmdParser.getCmdParam(1), "\"a b\"") == 0);
+    assert(strcmp(cmdParser.getCmdParam(2), "2") == 0);
+}
+
+// words behind the 16 bit token index are searched in the buffer
+static void testLongLine()
+{
+    CmdParser   cmdParser;
+    std::string line = "cmd a";
+
+    line.append(0xFFFF - line.size() - 2, ' ');
+    line += "bcd efg";
+
+    assert(cmdParser.parseCmd(&line[0]) == 3);
+    assert(strcmp(cmdParser.getCmdParam(1), "a") == 0);
+    assert(strcmp(cmdParser.getCmdParam(2), "bcd") == 0);
+    assert(strcmp(cmdParser.getCmdParam(3), "efg") == 0);
+    assert(cmdParser.getCmdParamView(2).size == 3);
+}
+
+// a buffer filled through getBuffer is parsed up to '\0'
+static void testFilledBuffer()
+{
+    CmdBuffer<32> cmdBuffer;
+    CmdParser     cmdParser;
+
+    strcpy(reinterpret_cast<char *>(cmdBuffer.getBuffer()), "led on");
+    assert(cmdParser.parseCmd(&cmdBuffer) == 1);
+    assert(strcmp(cmdParser.getCommand(), "led") == 0);
+    assert(strcmp(cmdParser.getCmdParam(1), "on") == 0);
+}
+
+int main()
+{
+    testStaticOptions();
+    testStaticIncremental();
+    testLongLine();
+    testFilledBuffer();
+    return 0;
+}
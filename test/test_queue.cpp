@@ -0,0 +1,140 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <thread>
+
+#include <CmdBuffer.h>
+#include <CmdParser.h>
+#include <CmdQueue.h>
+
+// a full queue drops bytes and count each failed write
+static void testFull()
+{
+    CmdQueue<4> queue;
+    uint8_t     data[8];
+
+    assert(queue.write(reinterpret_cast<const uint8_t *>("abcdef"), 6) == 4);
+    assert(queue.write('g') == false);
+    assert(queue.getDropCount() == 2);
+    assert(queue.available() == 4);
+    assert(queue.read(data, sizeof(data)) == 4);
+    assert(memcmp(data, "abcd", 4) == 0);
+    assert(queue.read() == -1);
+}
+
+// producer thread with bytes in a sequence, consumer checks the order
+static void testBytes()
+{
+    static CmdQueue<31> queue;
+    const uint32_t      count = 200000;
+
+    std::thread producer([&] {
+        uint8_t  data[7];
+        uint32_t next = 0;
+
+        while (next < count) {
+            if (next % 3 == 0) {
+                if (queue.write(static_cast<uint8_t>(next))) {
+                    next++;
+                } else {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+
+            size_t size = count - next < sizeof(data) ? count - next
+                                                      : sizeof(data);
+            for (size_t i = 0; i < size; i++) {
+                data[i] = static_cast<uint8_t>(next + i);
+            }
+            size = queue.write(data, size);
+            next += size;
+            if (size == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint8_t  data[5];
+    uint32_t next = 0;
+
+    while (next < count) {
+        if (next % 2 == 0) {
+            int value = queue.read();
+            if (value >= 0) {
+                assert(value == static_cast<uint8_t>(next));
+                next++;
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        size_t size = queue.read(data, sizeof(data));
+        for (size_t i = 0; i < size; i++, next++) {
+            assert(data[i] == static_cast<uint8_t>(next));
+        }
+        if (size == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    assert(queue.available() == 0);
+}
+
+// producer thread with lines, consumer parse them from a buffer
+static void testLines()
+{
+    static CmdQueue<61> queue;
+    CmdBuffer<64>       cmdBuffer;
+    CmdParser           cmdParser;
+    const int           count = 20000;
+
+    std::thread producer([&] {
+        char line[32];
+
+        for (int i = 0; i < count; i++) {
+            size_t size = snprintf(line, sizeof(line), "c %d\n", i);
+            size_t done = 0;
+
+            while (done < size) {
+                size_t added = queue.write(
+                    reinterpret_cast<const uint8_t *>(line) + done,
+                    size - done);
+                done += added;
+                if (added == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    for (int next = 0; next < count;) {
+        if (cmdBuffer.readFromQueue(&queue)) {
+            assert(cmdParser.parseCmd(&cmdBuffer) != CMDPARSER_ERROR);
+            assert(cmdParser.getCmdParamAsInt(1) == next);
+            cmdBuffer.clear();
+            next++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+}
+
+int main()
+{
+    testFull();
+    testBytes();
+    testLines();
+    return 0;
+}
@@ -0,0 +1,68 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <string>
+
+#include <CmdBuffer.h>
+#include <CmdCallback.h>
+#include <CmdParser.h>
+
+#include "MemStream.h"
+
+static std::string called;
+
+static void funct(CmdParser *cmdParser)
+{
+    called += cmdParser->getCommand();
+    called += cmdParser->getCmdParam(1);
+    called += ",";
+}
+
+// blank lines between commands are not queued
+static void testBlankLine()
+{
+    CmdCallback<2>    cmdCallback;
+    CmdRingBuffer<32> cmdBuffer;
+    CmdParser         cmdParser;
+    MemStream         serial("a 1\n\nb 2\r\n\na 3\n");
+
+    cmdCallback.addCmd("a", funct);
+    cmdCallback.addCmd("b", funct);
+
+    called.clear();
+    while (serial.available()) {
+        cmdCallback.updateCmdProcessing(&cmdParser, &cmdBuffer, &serial);
+    }
+    assert(called == "a1,b2,a3,");
+    assert(cmdBuffer.getLineCount() == 0);
+}
+
+// loop of a sketch, clear only after a parsed line
+static void testClearOnSuccess()
+{
+    CmdRingBuffer<32> cmdBuffer;
+    CmdParser         cmdParser;
+    const char *      data = "a 1\n\nb 2\n\n\na 3\n";
+    std::string       words;
+
+    for (const char *c = data; *c != 0x00; c++) {
+        if (cmdBuffer.readChars(reinterpret_cast<const uint8_t *>(c), 1) &&
+            cmdParser.parseCmd(&cmdBuffer) != CMDPARSER_ERROR) {
+            words += cmdParser.getCmdParam(1);
+            cmdBuffer.clear();
+        }
+    }
+    assert(words == "123");
+    assert(cmdBuffer.getLineCount() == 0);
+}
+
+int main()
+{
+    testBlankLine();
+    testClearOnSuccess();
+    return 0;
+}
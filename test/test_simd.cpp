@@ -0,0 +1,83 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ *
+ * Parse random lines and print a digest of the results for each block of
+ * lines. The output of a SIMD build and of a CMDPARSER_NO_SIMD build must
+ * be the same @see compare_output.cmake.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <random>
+
+#include <CmdParser.h>
+
+static uint64_t digest;
+
+static void mix(uint64_t value)
+{
+    digest = (digest ^ value) * 1099511628211ULL;
+}
+
+int main()
+{
+    const char   chars[] = "ab \"()=,;x\x01";
+    std::mt19937 rng(7);
+    uint8_t      line[320];
+
+    for (int block = 0; block < 200; block++) {
+        digest = 1469598103934665603ULL;
+
+        for (int i = 0; i < 1000; i++) {
+            CmdParser cmdParser;
+            size_t    size = rng() % ((i & 7) == 0 ? 319 : 79);
+            uint16_t  count;
+
+            for (size_t j = 0; j < size; j++) {
+                line[j] = chars[rng() % (sizeof(chars) - 1)];
+            }
+            line[size] = 0x00;
+            if (rng() % 7 == 0 && size > 3) {
+                line[rng() % size] = 0x00;
+            }
+
+            if (i & 1) {
+                cmdParser.setOptParens('(', ')');
+            }
+            if (i & 2) {
+                cmdParser.setOptIgnoreQuote();
+            }
+            if (i & 4) {
+                cmdParser.setOptSeperator(',');
+            }
+            if (i & 8) {
+                cmdParser.setOptCmdDelimiter(';');
+            }
+
+            count = cmdParser.parseCmd(line, size);
+            mix(count);
+            mix(cmdParser.getCmdCount());
+            if (count != CMDPARSER_ERROR) {
+                for (uint16_t k = 0; k <= count + 1; k++) {
+                    char *param = cmdParser.getCmdParam(k);
+                    mix(param != NULL ? param - (char *)line + 1 : 0);
+                    mix(cmdParser.getCmdParamLength(k));
+                }
+            }
+            mix(cmdParser.getErrorStr() != NULL);
+            mix(cmdParser.getWarningStr() != NULL
+                    ? strlen(cmdParser.getWarningStr())
+                    : 0);
+            for (size_t j = 0; j < size; j++) {
+                mix(line[j]);
+            }
+        }
+
+        printf("%d %016llx\n", block, (unsigned long long)digest);
+    }
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/* Copyright 2016 Pascal Vizeli <pvizeli@syshack.ch>
+ * BSD License
+ *
+ * https://github.com/pvizeli/CmdParser
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string>
+
+#include <CmdBuffer.h>
+#include <CmdCallback.h>
+#include <CmdParser.h>
+
+#include "MemStream.h"
+
+static CmdParser * parsers[2];
+static std::string called[2];
+
+static void up(CmdParser *cmdParser, uint16_t idx, uint16_t param)
+{
+    std::string &out = cmdParser == parsers[1] ? called[1] : called[0];
+
+    out += std::to_string(param);
+    if (idx == 0) {
+        out += "end:";
+        out += cmdParser->getCommand();
+        return;
+    }
+    out += "=";
+    out += cmdParser->getCmdParam(idx);
+    out += ",";
+}
+
+static void run(CmdCallbackObject *cmdCallback, CmdParser *cmdParser,
+                CmdBufferObject *cmdBuffer, const std::string &data)
+{
+    MemStream serial(data);
+
+    parsers[0] = cmdParser;
+    called[0].clear();
+    while (serial.available()) {
+        cmdCallback->updateCmdProcessing(cmdParser, cmdBuffer, &serial);
+    }
+}
+
+// params are numbered over all parts of the line
+static void testParamNumber()
+{
+    CmdCallback<2> cmdCallback;
+    CmdBuffer<12>  cmdBuffer;
+    CmdParser      cmdParser;
+
+    cmdBuffer.setParser(&cmdParser);
+    cmdCallback.addStreamCmd("up", up);
+
+    run(&cmdCallback, &cmdParser, &cmdBuffer, "up 11 22 33 44 55 66 77\n");
+    assert(called[0] == "1=11,2=22,3=33,4=44,5=55,6=66,7=77,7end:up");
+}
+
+// cmd word keeps its quotes after the buffer is rewound
+static void testQuotedCmd()
+{
+    CmdCallback<2> cmdCallback;
+    CmdBuffer<12>  cmdBuffer;
+    CmdParser      cmdParser;
+
+    cmdBuffer.setParser(&cmdParser);
+    cmdCallback.addStreamCmd("my up", up);
+
+    run(&cmdCallback, &cmdParser, &cmdBuffer, "\"my up\" 11 22 33 44\n");
+    assert(called[0] == "1=11,2=22,3=33,4=44,4end:my up");
+}
+
+static std::string trailer(const char *line)
+{
+    uint16_t crc = CMDBUFFER_CRC_INIT;
+    char     str[8];
+
+    for (const char *c = line; *c != 0x00; c++) {
+        crc = CmdBufferObject::crc16(crc, *c);
+    }
+    snprintf(str, sizeof(str), "*%04X\n", crc);
+    return str;
+}
+
+// params of a line with checksum are handed after it is verified
+static void testChecksum()
+{
+    CmdCallback<2> cmdCallback;
+    CmdBuffer<16>  cmdBuffer;
+    CmdParser      cmdParser;
+
+    cmdBuffer.setParser(&cmdParser);
+    cmdBuffer.setOptChecksum(CMDBUFFER_CHECK_CRC16);
+    cmdCallback.addStreamCmd("up", up);
+
+    run(&cmdCallback, &cmdParser, &cmdBuffer,
+        std::string("up 11 22 33") + trailer("up 11 22 33"));
+    assert(called[0] == "1=11,2=22,3=33,3end:up");
+
+    // corrupted line
+    run(&cmdCallback, &cmdParser, &cmdBuffer,
+        std::string("up 11 29 33") + trailer("up 11 22 33"));
+    assert(called[0] == "");
+}
+
+// backspace after a rewind keeps the CRC of the whole line
+static void testRewindChecksum()
+{
+    CmdBuffer<16> cmdBuffer;
+    std::string   data;
+    size_t        size;
+
+    cmdBuffer.setOptChecksum(CMDBUFFER_CHECK_CRC16);
+    assert(!cmdBuffer.readChars(reinterpret_cast<const uint8_t *>("up 11 "),
+                                6));
+    cmdBuffer.getLine(&size);
+    assert(size == 6);
+    cmdBuffer.rewindLine(3);
+
+    // kept data can't be removed
+    data = std::string("\b\b\b\b22x\b") + trailer("up 11 22");
+    assert(cmdBuffer.readChars(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+    assert(std::string(cmdBuffer.getStringFromBuffer()) == "up 22");
+}
+
+// one callback object serves two buffers
+static void testSharedCallback()
+{
+    CmdCallback<2> cmdCallback;
+    CmdBuffer<12>  cmdBuffer[2];
+    CmdParser      cmdParser[2];
+    MemStream      serial[2] = {MemStream("up 1 2 3 4 5\n"),
+                                MemStream("x 9\nup a b c\n")};
+
+    for (int i = 0; i < 2; i++) {
+        cmdBuffer[i].setParser(&cmdParser[i]);
+        parsers[i] = &cmdParser[i];
+        called[i].clear();
+    }
+    cmdCallback.addStreamCmd("up", up);
+
+    while (serial[0].available() || serial[1].available()) {
+        for (int i = 0; i < 2; i++) {
+            cmdCallback.updateCmdProcessing(&cmdParser[i], &cmdBuffer[i],
+                                            &serial[i]);
+        }
+    }
+    assert(called[0] == "1=1,2=2,3=3,4=4,5=5,5end:up");
+    assert(called[1] == "1=a,2=b,3=c,3end:up");
+}
+
+int main()
+{
+    testParamNumber();
+    testQuotedCmd();
+    testChecksum();
+    testRewindChecksum();
+    testSharedCallback();
+    return 0;
+}